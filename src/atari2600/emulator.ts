@@ -1,17 +1,205 @@
 import Stats from 'stats.js';
-import { createProgram, setupBuffers } from '../utils/graphics';
+import { createProgram, indexedFragmentShaderSource, setupBuffers, setupPaletteTexture } from '../utils/graphics';
+import { createRingBufferOutput } from '../utils/audio';
 
 /* ============================================================
    Constants and Global Variables
 ============================================================ */
-
+// Keyboard codes mapped to the core's keys: the P0 joystick, its fire button
+// and the Game Select / Game Reset console switches.
+const atariKeyMap: Record<string, number> = {
+  ArrowUp: 0, ArrowDown: 1, ArrowLeft: 2, ArrowRight: 3,
+  Space: 4, F1: 5, F2: 6
+};
 
 let rom: Uint8Array | null = null;
+let soundEnabled = true;
+let runAheadFrames = 0;
+let paletteRegion = 0;
+let rewinding = false; // Backspace held: play backwards
+let savedState: Uint8Array | null = null;
+let audioNode: AudioWorkletNode | null = null;
+const audioCtx = new AudioContext();
+
+// The core runs whole frames (see runFrame in wasm/atari2600/main.cpp). A scanline is
+// 76 cycles of the 1.19 MHz CPU, so a frame's duration follows from its scanline count.
+const MS_PER_SCANLINE = 76 / (3579545 / 3) * 1000;
+const NTSC_SCANLINES = 262;
+// Frames the loop may run to catch up after a stall (e.g. a background tab).
+const MAX_FRAMES_PER_TICK = 4;
 
 /* ============================================================
    Utility Functions
 ============================================================ */
 
+/**
+ * Starts sound output. The core synthesises the TIA's two channels into a shared
+ * ring buffer as it emulates, and an AudioWorklet drains it.
+ */
+async function startAudio(Module: any) {
+  const ringPtr = Module._initAudio(audioCtx.sampleRate);
+  audioNode = await createRingBufferOutput(audioCtx, Module.HEAPU8.buffer, ringPtr);
+  audioNode?.port.postMessage({ muted: !soundEnabled });
+  await audioCtx.resume();
+}
+
+/**
+ * Creates and inserts the sound checkbox (with label) into the DOM.
+ * This is called only after a ROM is loaded.
+ */
+function createSoundCheckbox(): HTMLInputElement {
+  const soundCheckbox = document.createElement('input');
+  soundCheckbox.type = 'checkbox';
+  soundCheckbox.checked = soundEnabled;
+  soundCheckbox.id = 'soundToggle';
+
+  const label = document.createElement('label');
+  label.htmlFor = 'soundToggle';
+  label.textContent = "Sound";
+
+  // Insert the checkbox and label before the canvas element.
+  const canvas = document.getElementById('glCanvas');
+  if (canvas && canvas.parentElement) {
+    canvas.parentElement.insertBefore(label, canvas);
+    canvas.parentElement.insertBefore(soundCheckbox, canvas);
+  }
+
+  soundCheckbox.addEventListener('change', () => {
+    soundEnabled = soundCheckbox.checked;
+    audioNode?.port.postMessage({ muted: !soundEnabled });
+  });
+
+  return soundCheckbox;
+}
+
+/**
+ * Creates and inserts the run-ahead selector (with label) into the DOM.
+ * Running ahead N frames hides N frames of input latency at the cost of
+ * emulating N extra frames per host frame.
+ */
+function createRunAheadSelect(): HTMLSelectElement {
+  const select = document.createElement('select');
+  select.id = 'runAheadSelect';
+  for (let frames = 0; frames <= 3; frames++) {
+    const option = document.createElement('option');
+    option.value = String(frames);
+    option.textContent = frames === 0 ? 'Off' : `${frames} frame${frames > 1 ? 's' : ''}`;
+    select.appendChild(option);
+  }
+  select.value = String(runAheadFrames);
+
+  const label = document.createElement('label');
+  label.htmlFor = 'runAheadSelect';
+  label.textContent = "Run-ahead";
+
+  // Insert the selector and label before the canvas element.
+  const canvas = document.getElementById('glCanvas');
+  if (canvas && canvas.parentElement) {
+    canvas.parentElement.insertBefore(label, canvas);
+    canvas.parentElement.insertBefore(select, canvas);
+  }
+
+  select.addEventListener('change', () => {
+    runAheadFrames = Number(select.value);
+  });
+
+  return select;
+}
+
+/**
+ * Creates and inserts the palette selector (with label) into the DOM.
+ * Automatic picks NTSC or PAL from the frame length; SECAM must be chosen.
+ */
+function createPaletteSelect(Module: any): HTMLSelectElement {
+  const select = document.createElement('select');
+  select.id = 'paletteSelect';
+  ['Auto', 'NTSC', 'PAL', 'SECAM'].forEach((name, region) => {
+    const option = document.createElement('option');
+    option.value = String(region);
+    option.textContent = name;
+    select.appendChild(option);
+  });
+  select.value = String(paletteRegion);
+
+  const label = document.createElement('label');
+  label.htmlFor = 'paletteSelect';
+  label.textContent = "Palette";
+
+  // Insert the selector and label before the canvas element.
+  const canvas = document.getElementById('glCanvas');
+  if (canvas && canvas.parentElement) {
+    canvas.parentElement.insertBefore(label, canvas);
+    canvas.parentElement.insertBefore(select, canvas);
+  }
+
+  select.addEventListener('change', () => {
+    paletteRegion = Number(select.value);
+    Module._setPalette(paletteRegion);
+  });
+
+  return select;
+}
+
+/**
+ * Creates the save and load state buttons. The state is kept in memory and only loads
+ * into the ROM it was saved from.
+ */
+function createStateButtons(Module: any) {
+  const saveButton = document.createElement('button');
+  saveButton.textContent = 'Save state';
+  const loadButton = document.createElement('button');
+  loadButton.textContent = 'Load state';
+
+  // Insert the buttons before the canvas element.
+  const canvas = document.getElementById('glCanvas');
+  if (canvas && canvas.parentElement) {
+    canvas.parentElement.insertBefore(saveButton, canvas);
+    canvas.parentElement.insertBefore(loadButton, canvas);
+  }
+
+  saveButton.addEventListener('click', () => {
+    const ptr = Module._saveSnapshot();
+    savedState = Module.HEAPU8.slice(ptr, ptr + Module._getSnapshotSize());
+  });
+
+  loadButton.addEventListener('click', () => {
+    if (!savedState) return;
+    const ptr = Module._malloc(savedState.length);
+    Module.HEAPU8.set(savedState, ptr);
+    if (!Module._loadSnapshot(ptr, savedState.length)) {
+      console.error("The saved state does not match this ROM or emulator version.");
+    }
+    Module._free(ptr);
+  });
+}
+
+/**
+ * In a trace build (yarn build:atari2600:trace), creates a button that saves the
+ * recorded instructions as atari2600.trace, for tools/atari2600/disassemble-trace.js.
+ */
+function createTraceButton(Module: any) {
+  if (!Module._getTrace) return;
+
+  const button = document.createElement('button');
+  button.textContent = 'Save trace';
+
+  // Insert the button before the canvas element.
+  const canvas = document.getElementById('glCanvas');
+  if (canvas && canvas.parentElement) {
+    canvas.parentElement.insertBefore(button, canvas);
+  }
+
+  button.addEventListener('click', () => {
+    const ptr = Module._getTrace();
+    const bytes = Module.HEAPU8.slice(ptr, ptr + Module._getTraceLength() * 24);
+    const link = document.createElement('a');
+    link.href = URL.createObjectURL(new Blob([bytes], { type: 'application/octet-stream' }));
+    link.download = 'atari2600.trace';
+    link.click();
+    setTimeout(() => URL.revokeObjectURL(link.href), 0);
+    Module._clearTrace();
+  });
+}
 
 /**
  * Initializes the emulator: loads the ROM, sets up WebGL,
@@ -24,6 +212,8 @@ function initEmulator(rom: Uint8Array, Module: any, canvas: HTMLCanvasElement) {
   Module._loadProgram(ptr, rom.length);
   Module._free(ptr);
 
+  startAudio(Module).catch((err) => console.error("Failed to start audio:", err));
+
   // Set up WebGL context and adjust canvas size.
   const gl = canvas.getContext('webgl');
   if (!gl) {
@@ -36,10 +226,22 @@ function initEmulator(rom: Uint8Array, Module: any, canvas: HTMLCanvasElement) {
   canvas.height = height * 10;
   gl.viewport(0, 0, gl.canvas.width, gl.canvas.height);
 
-  // Create shaders and buffers.
-  const program = createProgram(gl);
+  // Create shaders and buffers. The core's screen (one colour register value per pixel)
+  // is uploaded as a single-channel texture and coloured by the shader through a 256x1
+  // palette texture, which is only re-uploaded when the core switches palettes.
+  const program = createProgram(gl, indexedFragmentShaderSource);
   gl.useProgram(program);
   setupBuffers(gl, program);
+  const paletteTexture = setupPaletteTexture(gl, program);
+  gl.pixelStorei(gl.UNPACK_FLIP_Y_WEBGL, true);
+  gl.pixelStorei(gl.UNPACK_ALIGNMENT, 1);
+  gl.texImage2D(gl.TEXTURE_2D, 0, gl.LUMINANCE, width, height, 0, gl.LUMINANCE, gl.UNSIGNED_BYTE, null);
+
+  // Views of the core's screen and palette, recreated only when the core returns a
+  // different buffer, so the frame loop allocates nothing.
+  let pixelsPtr = 0;
+  let pixels = new Uint8Array(0);
+  let palettePtr = 0;
 
   // Set up performance stats in the top right.
   const stats = new Stats();
@@ -50,26 +252,72 @@ function initEmulator(rom: Uint8Array, Module: any, canvas: HTMLCanvasElement) {
   stats.dom.style.right = '0px';
   document.body.appendChild(stats.dom);
 
-  // Emulation loop.
+  // Set up keyboard listeners.
+  const handleKey = (fn: string) => (e: KeyboardEvent) => {
+    if (e.code === 'Backspace') {
+      e.preventDefault();
+      rewinding = fn === 'setKeyDown';
+      return;
+    }
+    const key = atariKeyMap[e.code];
+    if (key !== undefined) {
+      e.preventDefault();
+      Module[`_${fn}`](key);
+    }
+  };
+  document.addEventListener('keydown', handleKey('setKeyDown'));
+  document.addEventListener('keyup', handleKey('setKeyUp'));
+
+  // Emulation loop. Elapsed time is banked and spent one emulated frame at a time, each
+  // costing its real duration, so NTSC and PAL games both run at their own rate. Only the
+  // last frame of a tick runs ahead, since it is the one shown.
   let last = performance.now();
+  let timeBank = 0;
+  let frameMs = NTSC_SCANLINES * MS_PER_SCANLINE;
   function loop() {
     if (!gl) return;
 
-    
     stats.begin();
     const now = performance.now();
-    const delta = now - last;
+    timeBank = Math.min(timeBank + now - last, MAX_FRAMES_PER_TICK * frameMs);
     last = now;
 
-    Module._run(delta);
+    // FrameStatus: scanlines, frameChanged, audioSamples (int32 each).
+    let screenChanged = false;
+    while (rewinding && timeBank >= frameMs) {
+      timeBank -= frameMs;
+      screenChanged = Module._rewindFrames(1) > 0 || screenChanged;
+    }
+    while (timeBank >= frameMs) {
+      timeBank -= frameMs;
+      const statusPtr = timeBank < frameMs ? Module._runAhead(runAheadFrames) : Module._runFrame();
+      const [scanlines, frameChanged] = new Int32Array(Module.HEAPU8.buffer, statusPtr, 3);
+      if (scanlines > 0) frameMs = scanlines * MS_PER_SCANLINE;
+      screenChanged = screenChanged || frameChanged !== 0;
+    }
+
+    // Upload the palette if it changed (selected by hand or NTSC/PAL detected).
+    const newPalettePtr = Module._getPalette();
+    if (newPalettePtr !== palettePtr) {
+      palettePtr = newPalettePtr;
+      const palette = new Uint8Array(Module.HEAPU8.buffer, palettePtr, 256 * 4);
+      gl.activeTexture(gl.TEXTURE1);
+      gl.bindTexture(gl.TEXTURE_2D, paletteTexture);
+      gl.texSubImage2D(gl.TEXTURE_2D, 0, 0, 0, 256, 1, gl.RGBA, gl.UNSIGNED_BYTE, palette);
+      gl.activeTexture(gl.TEXTURE0);
+      screenChanged = true;
+    }
 
-    // Render emulator screen.
-    const screenPtr = Module._getScreen();
-    const pixels = new Uint8Array(Module.HEAPU8.buffer, screenPtr, width * height * 3);
-    
-    gl.pixelStorei(gl.UNPACK_FLIP_Y_WEBGL, true);
-    gl.texImage2D(gl.TEXTURE_2D, 0, gl.RGB, width, height, 0, gl.RGB, gl.UNSIGNED_BYTE, pixels);
-    gl.drawArrays(gl.TRIANGLES, 0, 6);
+    // Upload and draw the screen only when it changed; the canvas keeps the last picture.
+    if (screenChanged) {
+      const screenPtr = Module._getScreen();
+      if (screenPtr !== pixelsPtr) {
+        pixelsPtr = screenPtr;
+        pixels = new Uint8Array(Module.HEAPU8.buffer, screenPtr, width * height);
+      }
+      gl.texSubImage2D(gl.TEXTURE_2D, 0, 0, 0, width, height, gl.LUMINANCE, gl.UNSIGNED_BYTE, pixels);
+      gl.drawArrays(gl.TRIANGLES, 0, 6);
+    }
 
     stats.end();
     requestAnimationFrame(loop);
@@ -105,6 +353,11 @@ function setupFileLoader(Module: any, canvas: HTMLCanvasElement) {
           rom = new Uint8Array(arrayBuffer);
           fileInput.remove();
           canvas.style.display = 'block';
+          createSoundCheckbox();
+          createRunAheadSelect();
+          createPaletteSelect(Module);
+          createStateButtons(Module);
+          createTraceButton(Module);
           initEmulator(rom, Module, canvas);
         }
       };
@@ -141,6 +394,10 @@ async function startApp() {
   if (!rom || rom.length === 0) {
     setupFileLoader(Module, canvas);
   } else {
+    createSoundCheckbox();
+    createRunAheadSelect();
+    createPaletteSelect(Module);
+    createTraceButton(Module);
     initEmulator(rom, Module, canvas);
   }
 }
@@ -1,5 +1,6 @@
 import Stats from 'stats.js';
-import { createProgram, setupBuffers } from '../utils/graphics';
+import { createProgram, monochromeFragmentShaderSource, setupBuffers } from '../utils/graphics';
+import { createRingBufferOutput } from '../utils/audio';
 
 /* ============================================================
    Constants and Global Variables
@@ -13,7 +14,8 @@ const chip8KeyMap: Record<string, number> = {
 
 let rom: Uint8Array | null = null;
 let soundEnabled = true;
-let oscillator: OscillatorNode | null = null;
+let runAheadFrames = 0;
+let audioNode: AudioWorkletNode | null = null;
 const audioCtx = new AudioContext();
 
 /* ============================================================
@@ -21,24 +23,14 @@ const audioCtx = new AudioContext();
 ============================================================ */
 
 /**
- * Updates sound output based on the Chip8 sound timer.
+ * Starts sound output. The core synthesises samples in lockstep with its sound
+ * timer into a shared ring buffer, and an AudioWorklet drains it.
  */
-function updateSound(Module: any) {
-  const st = Module._getSoundTimer();
-  if (soundEnabled && st > 0) {
-    if (!oscillator) {
-      const osc = audioCtx.createOscillator();
-      osc.type = 'square';
-      osc.frequency.value = 440;
-      osc.connect(audioCtx.destination);
-      osc.start();
-      oscillator = osc;
-    }
-  } else if (oscillator) {
-    oscillator.stop();
-    oscillator.disconnect();
-    oscillator = null;
-  }
+async function startAudio(Module: any) {
+  const ringPtr = Module._initAudio(audioCtx.sampleRate);
+  audioNode = await createRingBufferOutput(audioCtx, Module.HEAPU8.buffer, ringPtr);
+  audioNode?.port.postMessage({ muted: !soundEnabled });
+  await audioCtx.resume();
 }
 
 /**
@@ -64,11 +56,46 @@ function createSoundCheckbox(): HTMLInputElement {
   
   soundCheckbox.addEventListener('change', () => {
     soundEnabled = soundCheckbox.checked;
+    audioNode?.port.postMessage({ muted: !soundEnabled });
   });
 
   return soundCheckbox;
 }
 
+/**
+ * Creates and inserts the run-ahead selector (with label) into the DOM.
+ * Running ahead N frames hides N frames of input latency at the cost of
+ * emulating N extra frames per host frame.
+ */
+function createRunAheadSelect(): HTMLSelectElement {
+  const select = document.createElement('select');
+  select.id = 'runAheadSelect';
+  for (let frames = 0; frames <= 3; frames++) {
+    const option = document.createElement('option');
+    option.value = String(frames);
+    option.textContent = frames === 0 ? 'Off' : `${frames} frame${frames > 1 ? 's' : ''}`;
+    select.appendChild(option);
+  }
+  select.value = String(runAheadFrames);
+
+  const label = document.createElement('label');
+  label.htmlFor = 'runAheadSelect';
+  label.textContent = "Run-ahead";
+
+  // Insert the selector and label before the canvas element.
+  const canvas = document.getElementById('glCanvas');
+  if (canvas && canvas.parentElement) {
+    canvas.parentElement.insertBefore(label, canvas);
+    canvas.parentElement.insertBefore(select, canvas);
+  }
+
+  select.addEventListener('change', () => {
+    runAheadFrames = Number(select.value);
+  });
+
+  return select;
+}
+
 /**
  * Initializes the emulator: loads the ROM, sets up WebGL,
  * creates shaders, and starts the main emulation loop.
@@ -80,6 +107,8 @@ function initEmulator(rom: Uint8Array, Module: any, canvas: HTMLCanvasElement) {
   Module._loadProgram(ptr, rom.length);
   Module._free(ptr);
 
+  startAudio(Module).catch((err) => console.error("Failed to start audio:", err));
+
   // Set up WebGL context and adjust canvas size.
   const gl = canvas.getContext('webgl');
   if (!gl) {
@@ -92,10 +121,19 @@ function initEmulator(rom: Uint8Array, Module: any, canvas: HTMLCanvasElement) {
   canvas.height = height * 10;
   gl.viewport(0, 0, gl.canvas.width, gl.canvas.height);
 
-  // Create shaders and buffers.
-  const program = createProgram(gl);
+  // Create shaders and buffers. The core's screen (one byte per pixel, 0 or 1) is
+  // uploaded as a single-channel texture and expanded to white-on-black by the shader.
+  const program = createProgram(gl, monochromeFragmentShaderSource);
   gl.useProgram(program);
   setupBuffers(gl, program);
+  gl.pixelStorei(gl.UNPACK_FLIP_Y_WEBGL, true);
+  gl.pixelStorei(gl.UNPACK_ALIGNMENT, 1);
+  gl.texImage2D(gl.TEXTURE_2D, 0, gl.LUMINANCE, width, height, 0, gl.LUMINANCE, gl.UNSIGNED_BYTE, null);
+
+  // View of the core's screen buffer. It is only recreated when the core starts returning a
+  // different buffer (e.g. when run-ahead is toggled), so the frame loop allocates nothing.
+  let pixelsPtr = 0;
+  let pixels = new Uint8Array(0);
 
   // Set up performance stats in the top right.
   const stats = new Stats();
@@ -127,24 +165,17 @@ function initEmulator(rom: Uint8Array, Module: any, canvas: HTMLCanvasElement) {
     const delta = now - last;
     last = now;
 
-    Module._run(delta);
+    Module._runAhead(delta, runAheadFrames);
 
     // Render emulator screen.
     const screenPtr = Module._getScreen();
-    const pixels = new Uint8Array(Module.HEAPU8.buffer, screenPtr, width * height);
-    const img = new Uint8Array(width * height * 4);
-    for (let i = 0; i < pixels.length; i++) {
-      const v = pixels[i] ? 255 : 0;
-      img[i * 4] = v;
-      img[i * 4 + 1] = v;
-      img[i * 4 + 2] = v;
-      img[i * 4 + 3] = 255;
+    if (screenPtr !== pixelsPtr) {
+      pixelsPtr = screenPtr;
+      pixels = new Uint8Array(Module.HEAPU8.buffer, screenPtr, width * height);
     }
-    gl.pixelStorei(gl.UNPACK_FLIP_Y_WEBGL, true);
-    gl.texImage2D(gl.TEXTURE_2D, 0, gl.RGBA, width, height, 0, gl.RGBA, gl.UNSIGNED_BYTE, img);
+    gl.texSubImage2D(gl.TEXTURE_2D, 0, 0, 0, width, height, gl.LUMINANCE, gl.UNSIGNED_BYTE, pixels);
     gl.drawArrays(gl.TRIANGLES, 0, 6);
 
-    updateSound(Module);
     stats.end();
     requestAnimationFrame(loop);
   }
@@ -187,6 +218,7 @@ function setupFileLoader(Module: any, canvas: HTMLCanvasElement) {
           fileInput.remove();
           canvas.style.display = 'block';
           createSoundCheckbox();
+          createRunAheadSelect();
           initEmulator(rom, Module, canvas);
         }
       };
@@ -224,6 +256,7 @@ async function startApp() {
     setupFileLoader(Module, canvas);
   } else {
     createSoundCheckbox();
+    createRunAheadSelect();
     initEmulator(rom, Module, canvas);
   }
 }
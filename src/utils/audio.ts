@@ -0,0 +1,33 @@
+/**
+ * Connects a core's shared audio ring buffer to the speakers.
+ *
+ * The core synthesises samples into a lock-free ring inside its wasm heap and
+ * the ring-buffer-processor AudioWorklet reads them directly from that heap,
+ * so no audio work happens on the main thread. This requires the heap to be a
+ * SharedArrayBuffer (the cores are built with -sSHARED_MEMORY=1), which in turn
+ * requires the page to be cross-origin isolated (see vite.config.ts).
+ *
+ * @param audioCtx The AudioContext to play through.
+ * @param heap     The core's wasm heap (Module.HEAPU8.buffer).
+ * @param ringPtr  Address of the core's AudioRing within the heap.
+ * @returns The worklet node, or null if shared memory is unavailable.
+ */
+export async function createRingBufferOutput(
+  audioCtx: AudioContext,
+  heap: ArrayBufferLike,
+  ringPtr: number
+): Promise<AudioWorkletNode | null> {
+  if (typeof SharedArrayBuffer === 'undefined' || !(heap instanceof SharedArrayBuffer)) {
+    console.error("Audio disabled: the wasm heap is not shared. Is the page cross-origin isolated?");
+    return null;
+  }
+
+  await audioCtx.audioWorklet.addModule(new URL('./ring-buffer-processor.js', import.meta.url));
+  const node = new AudioWorkletNode(audioCtx, 'ring-buffer-processor', {
+    numberOfInputs: 0,
+    outputChannelCount: [1],
+    processorOptions: { buffer: heap, ringPtr },
+  });
+  node.connect(audioCtx.destination);
+  return node;
+}
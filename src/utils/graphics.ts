@@ -17,6 +17,32 @@ void main() {
 }
 `;
 
+// Expands a single-channel on/off framebuffer (one byte per pixel, 0 or 1) to
+// white-on-black, so 1-bit screens can be uploaded as-is without a CPU pass.
+export const monochromeFragmentShaderSource = `
+precision mediump float;
+varying vec2 v_texCoord;
+uniform sampler2D u_texture;
+void main() {
+  float on = step(0.5 / 255.0, texture2D(u_texture, v_texCoord).r);
+  gl_FragColor = vec4(vec3(on), 1.0);
+}
+`;
+
+// Maps a single-channel framebuffer of colour indices (one byte per pixel) through a
+// 256x1 RGBA palette texture bound to texture unit 1, so indexed screens are uploaded
+// as-is and switching palettes only replaces the small palette texture.
+export const indexedFragmentShaderSource = `
+precision mediump float;
+varying vec2 v_texCoord;
+uniform sampler2D u_texture;
+uniform sampler2D u_palette;
+void main() {
+  float index = texture2D(u_texture, v_texCoord).r * 255.0;
+  gl_FragColor = texture2D(u_palette, vec2((index + 0.5) / 256.0, 0.5));
+}
+`;
+
 export function createShader(
   gl: WebGLRenderingContext,
   source: string,
@@ -34,10 +60,11 @@ export function createShader(
 }
 
 export function createProgram(
-  gl: WebGLRenderingContext
+  gl: WebGLRenderingContext,
+  fragmentSource: string = fragmentShaderSource
 ): WebGLProgram {
   const vs = createShader(gl, vertexShaderSource, gl.VERTEX_SHADER);
-  const fs = createShader(gl, fragmentShaderSource, gl.FRAGMENT_SHADER);
+  const fs = createShader(gl, fragmentSource, gl.FRAGMENT_SHADER);
   const program = gl.createProgram()!;
   gl.attachShader(program, vs);
   gl.attachShader(program, fs);
@@ -88,4 +115,20 @@ export function setupBuffers(gl: WebGLRenderingContext, program: WebGLProgram) {
   gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_S, gl.CLAMP_TO_EDGE);
   gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_T, gl.CLAMP_TO_EDGE);
   gl.uniform1i(gl.getUniformLocation(program, 'u_texture'), 0);
-}
\ No newline at end of file
+}
+
+// Creates the 256x1 palette texture read by indexedFragmentShaderSource on texture unit 1.
+// Texture unit 0 is left active for the screen texture created by setupBuffers.
+export function setupPaletteTexture(gl: WebGLRenderingContext, program: WebGLProgram): WebGLTexture {
+  const texture = gl.createTexture()!;
+  gl.activeTexture(gl.TEXTURE1);
+  gl.bindTexture(gl.TEXTURE_2D, texture);
+  gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MIN_FILTER, gl.NEAREST);
+  gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MAG_FILTER, gl.NEAREST);
+  gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_S, gl.CLAMP_TO_EDGE);
+  gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_T, gl.CLAMP_TO_EDGE);
+  gl.texImage2D(gl.TEXTURE_2D, 0, gl.RGBA, 256, 1, 0, gl.RGBA, gl.UNSIGNED_BYTE, null);
+  gl.uniform1i(gl.getUniformLocation(program, 'u_palette'), 1);
+  gl.activeTexture(gl.TEXTURE0);
+  return texture;
+}
@@ -0,0 +1,58 @@
+/**
+ * AudioWorklet processor that drains a core's AudioRing straight out of the
+ * shared wasm heap. See wasm/common/audio_ring.h for the memory layout.
+ *
+ * This file is loaded with audioWorklet.addModule() and runs on the audio
+ * rendering thread, so it is plain JavaScript with no imports.
+ */
+class RingBufferProcessor extends AudioWorkletProcessor {
+  constructor(options) {
+    super();
+    const { buffer, ringPtr } = options.processorOptions;
+    // Header: [writeIndex, readIndex, capacity, reserved], then the samples.
+    this.header = new Uint32Array(buffer, ringPtr, 4);
+    this.capacity = this.header[2];
+    this.samples = new Float32Array(buffer, ringPtr + 16, this.capacity);
+    this.muted = false;
+    this.last = 0;
+    this.port.onmessage = (event) => {
+      if (typeof event.data.muted === 'boolean') {
+        this.muted = event.data.muted;
+      }
+    };
+  }
+
+  process(_inputs, outputs) {
+    const output = outputs[0];
+    const channel = output[0];
+    const write = Atomics.load(this.header, 0);
+    let read = Atomics.load(this.header, 1);
+    const available = (write - read) >>> 0;
+    const count = Math.min(available, channel.length);
+    const mask = this.capacity - 1;
+
+    for (let i = 0; i < count; i++) {
+      channel[i] = this.samples[(read + i) & mask];
+    }
+    if (count > 0) {
+      this.last = channel[count - 1];
+    }
+    // On underrun, decay from the last sample instead of dropping to zero to avoid a click.
+    for (let i = count; i < channel.length; i++) {
+      this.last *= 0.99;
+      channel[i] = this.last;
+    }
+    read = (read + count) >>> 0;
+    Atomics.store(this.header, 1, read);
+
+    if (this.muted) {
+      channel.fill(0);
+    }
+    for (let c = 1; c < output.length; c++) {
+      output[c].set(channel);
+    }
+    return true;
+  }
+}
+
+registerProcessor('ring-buffer-processor', RingBufferProcessor);
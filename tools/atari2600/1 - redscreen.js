@@ -12,9 +12,8 @@ import * as fs from 'fs';
      - **LDA #$80:** The program loads the constant value 0x80 into the accumulator (A). 
        This value is chosen because, when processed by our palette lookup, it will map to a 
        specific color (for example, red if our palette is set up that way).
-     - **STA $08:** The value in the accumulator (A) is stored into the zero-page address $08. 
-       In our emulator, this address is mapped to the TIA register that controls the background 
-       color (COLUBK). This immediately sets the screen's background to the new color.
+     - **STA $09:** The value in the accumulator (A) is stored into the zero-page address $09, 
+       the TIA register that controls the background color (COLUBK). This immediately sets the screen's background to the new color.
   
   2. **Set Up a Delay Loop:**
      - **LDY #$FF:** The Y register is loaded with 0xFF. This value will serve as the outer loop 
@@ -39,7 +38,7 @@ import * as fs from 'fs';
        jumps back to address $0000 to restart the process.
   
   Overall, this program continuously:
-  - Sets the background color (using a value loaded into A and stored into TIA register $08),
+  - Sets the background color (using a value loaded into A and stored into TIA register $09),
   - Runs a delay loop so that the color remains on the screen for a perceptible time (approximately one second),
   - And then loops back to repeat the process.
   
@@ -50,7 +49,7 @@ import * as fs from 'fs';
 
 const program = [
   0xA9, 0x80,       // LDA #$80  — Load immediate value 0x80 (red) into the accumulator.
-  0x85, 0x08,       // STA $08   — Store the accumulator to zero-page address $08 (this is our TIA register for background color).
+  0x85, 0x09,       // STA $09   — Store the accumulator to zero-page address $09 (the TIA background color register, COLUBK).
   0xA0, 0xFF,       // LDY #$FF  — Load Y register with 0xFF (outer loop counter for delay).
   0xA2, 0xFF,       // LDX #$FF  — Load X register with 0xFF (inner loop counter for delay).
   0xCA,             // DEX       — Decrement X.
@@ -71,6 +70,10 @@ if (romBuffer.length < romSize) {
   romBuffer = Buffer.concat([romBuffer, padding]);
 }
 
+// Reset vector ($FFFC): the CPU starts executing at $F000.
+romBuffer[0xFFC] = 0x00;
+romBuffer[0xFFD] = 0xF0;
+
 // Write the ROM to a file.
 fs.writeFileSync('./roms/atari2600/1 - redscreen.a26', romBuffer);
 console.log(`Wrote ${romBuffer.length} bytes to 1 - redscreen.a26`);
\ No newline at end of file
@@ -3,7 +3,7 @@ import * as fs from 'fs';
 /*
   This Atari 2600 ROM is a very simple program that continuously cycles the background color.
   It works by incrementing a seed value stored at zero-page address $80 and then copying that
-  value to zero-page address $08, which our emulator maps to the TIA background color (COLUBK).
+  value to zero-page address $09, the TIA background color register (COLUBK).
   
   The program works as follows:
 
@@ -11,7 +11,7 @@ import * as fs from 'fs';
      - **INC $80 (E6 80):** Increment the seed stored at memory address $80.
        (This causes the seed to wrap from 0xFF back to 0x00.)
      - **LDA $80 (A5 80):** Load the updated seed from $80 into the accumulator (A).
-     - **STA $08 (85 08):** Store the value in A into address $08, which is mapped to the
+     - **STA $09 (85 09):** Store the value in A into address $09, which is mapped to the
        TIA register controlling the background color. This sets the new background color for the frame.
 
   2. **Delay Loop (Busy-Wait):**
@@ -45,7 +45,7 @@ import * as fs from 'fs';
 const program = [
   0xE6, 0x80,       // INC $80   — Increment the seed at $80.
   0xA5, 0x80,       // LDA $80   — Load the updated seed from $80 into the accumulator.
-  0x85, 0x08,       // STA $08   — Store the value to $08 (mapped to the TIA background color register).
+  0x85, 0x09,       // STA $09   — Store the value to $09 (the TIA background color register, COLUBK).
   0xA0, 0x40,       // LDY #$40  — Load Y with 0x40 (64 iterations for outer delay loop).
   0xA2, 0x40,       // LDX #$40  — Load X with 0x40 (64 iterations for inner delay loop).
   0xCA,             // DEX       — Decrement X.
@@ -66,6 +66,10 @@ if (romBuffer.length < romSize) {
   romBuffer = Buffer.concat([romBuffer, padding]);
 }
 
+// Reset vector ($FFFC): the CPU starts executing at $F000.
+romBuffer[0xFFC] = 0x00;
+romBuffer[0xFFD] = 0xF0;
+
 // Write the ROM to a file.
 fs.writeFileSync('./roms/atari2600/2 - cycle-colors.a26', romBuffer);
 console.log(`Wrote ${romBuffer.length} bytes to 2 - cycle-colors.a26`);
\ No newline at end of file
@@ -12,7 +12,9 @@ import * as fs from 'fs';
      When combined and mirrored, these values form a symmetric vertical stripe pattern.
   
   2. **Set Background Color:**
-     - LDA #$80, STA $08: Sets the background color to 0x80 (which maps to red via the palette).
+     - LDA #$80, STA $09: Sets the background color (COLUBK) to 0x80 (which maps to red via the palette).
+     - LDA #$70, STA $08: Sets the playfield color (COLUPF) to 0x70.
+     - LDA #$01, STA $0A: Sets CTRLPF so the right half of the playfield mirrors the left.
   
   3. **Delay Loop:**
      A simple busy‑wait loop is executed using LDY and LDX loaded with 0x10, creating a short delay.
@@ -31,7 +33,11 @@ const program = [
   0xA9, 0xFF,       // LDA #$FF  — Load 0xFF into A.
   0x85, 0x0F,       // STA $0F   — Store A into PF2.
   0xA9, 0x80,       // LDA #$80  — Load 0x80 into A (background color).
-  0x85, 0x08,       // STA $08   — Store A into $08 (TIA background color).
+  0x85, 0x09,       // STA $09   — Store A into $09 (TIA background color, COLUBK).
+  0xA9, 0x70,       // LDA #$70  — Load 0x70 into A (playfield color).
+  0x85, 0x08,       // STA $08   — Store A into $08 (TIA playfield color, COLUPF).
+  0xA9, 0x01,       // LDA #$01  — Load 0x01 into A.
+  0x85, 0x0A,       // STA $0A   — Store A into CTRLPF (reflect the right half of the playfield).
   0xA0, 0x10,       // LDY #$10  — Outer loop counter for delay.
   0xA2, 0x10,       // LDX #$10  — Inner loop counter for delay.
   0xCA,             // DEX       — Decrement X.
@@ -52,5 +58,9 @@ if (romBuffer.length < romSize) {
 // (In this ROM, the seed is not used for random behavior.)
 romBuffer[0x80] = 0xAB;
 
+// Reset vector ($FFFC): the CPU starts executing at $F000.
+romBuffer[0xFFC] = 0x00;
+romBuffer[0xFFD] = 0xF0;
+
 fs.writeFileSync('./roms/atari2600/3 - playfield - vertical stripes.a26', romBuffer);
 console.log(`Wrote ${romBuffer.length} bytes to 3 - playfield - vertical stripes.a26`);
\ No newline at end of file
@@ -9,7 +9,8 @@ import * as fs from 'fs';
   When these values are combined and mirrored, they form an alternating pattern.
   
   Additionally:
-  - The background color is set via $08 (using LDA #$10, STA $08), which may map to dark blue.
+  - The background color is set via COLUBK at $09 (using LDA #$10, STA $09), which may map to dark blue.
+  - The playfield color is set via COLUPF at $08, and CTRLPF at $0A is set to mirror the playfield.
   - A delay loop (using LDY and LDX loaded with 0x10) creates a short busy-wait delay.
   - The program then jumps back to $F000 to repeat the process.
   
@@ -28,7 +29,11 @@ const program = [
 
   // Set background color.
   0xA9, 0x10,       // LDA #$10  — Load 0x10 into A (background color index).
-  0x85, 0x08,       // STA $08   — Store A into $08 (TIA background color).
+  0x85, 0x09,       // STA $09   — Store A into $09 (TIA background color, COLUBK).
+  0xA9, 0x70,       // LDA #$70  — Load 0x70 into A (playfield color).
+  0x85, 0x08,       // STA $08   — Store A into $08 (TIA playfield color, COLUPF).
+  0xA9, 0x01,       // LDA #$01  — Load 0x01 into A.
+  0x85, 0x0A,       // STA $0A   — Store A into CTRLPF (reflect the right half of the playfield).
 
   // Delay Loop
   0xA0, 0x10,       // LDY #$10  — Outer loop counter.
@@ -52,5 +57,9 @@ if (romBuffer.length < romSize) {
 // Initialize seed at $80 for consistency (even though this ROM doesn't use it for randomness).
 romBuffer[0x80] = 0xAB;
 
+// Reset vector ($FFFC): the CPU starts executing at $F000.
+romBuffer[0xFFC] = 0x00;
+romBuffer[0xFFD] = 0xF0;
+
 fs.writeFileSync('./roms/atari2600/4 - playfield - checkerboard.a26', romBuffer);
 console.log(`Wrote ${romBuffer.length} bytes to 4 - playfield - checkerboard.a26`);
\ No newline at end of file
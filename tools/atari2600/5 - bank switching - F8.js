@@ -0,0 +1,114 @@
+import * as fs from 'fs';
+
+/*
+  F8 Bank Switching ROM
+
+  An 8K ROM in the F8 scheme: two 4K banks, both seen at $F000-$FFFF, selected by
+  accessing $1FF8 (bank 0) or $1FF9 (bank 1). Each bank draws a whole frame and then
+  switches to the other one, so the banks alternate every frame.
+
+  1. **Reset ($FF90, the same in both banks):**
+     Clears RAM and the stack, selects bank 0 and jumps to the frame code at $F000.
+
+  2. **Frame ($F000, in each bank):**
+     - Three lines of VSYNC and 37 lines of VBLANK.
+     - 192 visible lines. Each sets the background colour to the line number plus the frame
+       counter at $80, EORed with a value that differs per bank ($00 or $F0), and rotates a
+       17-bit shift register at $81-$82 twice. Its high byte becomes PF1 and the playfield
+       colour. The rotation is plain CPU work on RAM, the kind of loop the block recompiler
+       translates.
+     - 30 lines of overscan, then the frame counter is incremented and copied into the
+       shift register.
+
+  3. **Switch ($FF80):**
+     Bank 0 reads $1FF9 and bank 1 reads $1FF8. The next instruction, at $FF83, is fetched
+     from the other bank, where it is the same JMP $F000.
+
+  A core that fails to switch banks, or keeps running code from the wrong bank, draws the
+  wrong colours on every other frame.
+*/
+
+function frameCode(colorMask) {
+  return [
+    // VSYNC
+    0xA9, 0x02,       // F000 LDA #$02
+    0x85, 0x02,       // F002 STA WSYNC
+    0x85, 0x00,       // F004 STA VSYNC
+    0x85, 0x02,       // F006 STA WSYNC
+    0x85, 0x02,       // F008 STA WSYNC
+    0x85, 0x02,       // F00A STA WSYNC
+    0xA9, 0x00,       // F00C LDA #$00
+    0x85, 0x00,       // F00E STA VSYNC
+    // VBLANK
+    0xA2, 0x25,       // F010 LDX #37
+    0x85, 0x02,       // F012 STA WSYNC
+    0xCA,             // F014 DEX
+    0xD0, 0xFB,       // F015 BNE $F012
+    0x86, 0x01,       // F017 STX VBLANK  — X is 0: the picture starts.
+    // Visible lines
+    0xA0, 0xC0,       // F019 LDY #192
+    0x98,             // F01B TYA
+    0x18,             // F01C CLC
+    0x65, 0x80,       // F01D ADC $80     — Line number plus frame counter.
+    0x49, colorMask,  // F01F EOR #mask   — Differs per bank.
+    0x85, 0x02,       // F021 STA WSYNC
+    0x85, 0x09,       // F023 STA COLUBK
+    0xA2, 0x02,       // F025 LDX #2
+    0x26, 0x81,       // F027 ROL $81     — Rotate the shift register...
+    0x26, 0x82,       // F029 ROL $82
+    0xCA,             // F02B DEX
+    0xD0, 0xF9,       // F02C BNE $F027   — ...twice per line.
+    0xA5, 0x82,       // F02E LDA $82
+    0x85, 0x08,       // F030 STA COLUPF
+    0x85, 0x0E,       // F032 STA PF1
+    0x88,             // F034 DEY
+    0xD0, 0xE4,       // F035 BNE $F01B
+    // Overscan
+    0xA9, 0x02,       // F037 LDA #$02
+    0x85, 0x01,       // F039 STA VBLANK
+    0xA2, 0x1E,       // F03B LDX #30
+    0x85, 0x02,       // F03D STA WSYNC
+    0xCA,             // F03F DEX
+    0xD0, 0xFB,       // F040 BNE $F03D
+    0xE6, 0x80,       // F042 INC $80     — Next frame.
+    0xA5, 0x80,       // F044 LDA $80
+    0x85, 0x81,       // F046 STA $81     — Reseed the shift register.
+    0x4C, 0x80, 0xFF, // F048 JMP $FF80   — Switch banks.
+  ];
+}
+
+const reset = [
+  0x78,             // FF90 SEI
+  0xD8,             // FF91 CLD
+  0xA2, 0xFF,       // FF92 LDX #$FF
+  0x9A,             // FF94 TXS
+  0xA9, 0x00,       // FF95 LDA #$00
+  0xA2, 0x7F,       // FF97 LDX #$7F
+  0x95, 0x80,       // FF99 STA $80,X   — Clear RAM.
+  0xCA,             // FF9B DEX
+  0x10, 0xFB,       // FF9C BPL $FF99
+  0xAD, 0xF8, 0xFF, // FF9E LDA $FFF8   — Select bank 0...
+  0x4C, 0x00, 0xF0, // FFA1 JMP $F000   — ...and continue there.
+];
+
+const bankSize = 4096;
+const romBuffer = Buffer.alloc(2 * bankSize, 0);
+
+for (let bank = 0; bank < 2; bank++) {
+  const base = bank * bankSize;
+  romBuffer.set(frameCode(bank ? 0xF0 : 0x00), base);
+  romBuffer.set([
+    0xAD, bank ? 0xF8 : 0xF9, 0xFF, // FF80 LDA $FFF9 (bank 0) or $FFF8 (bank 1) — Switch.
+    0x4C, 0x00, 0xF0,               // FF83 JMP $F000 — Runs in the other bank.
+  ], base + 0xF80);
+  romBuffer.set(reset, base + 0xF90);
+
+  // Reset and IRQ vectors: $FF90 in both banks, since either may be selected at power-on.
+  romBuffer[base + 0xFFC] = 0x90;
+  romBuffer[base + 0xFFD] = 0xFF;
+  romBuffer[base + 0xFFE] = 0x90;
+  romBuffer[base + 0xFFF] = 0xFF;
+}
+
+fs.writeFileSync('./roms/atari2600/5 - bank switching - F8.a26', romBuffer);
+console.log(`Wrote ${romBuffer.length} bytes to 5 - bank switching - F8.a26`);
@@ -0,0 +1,116 @@
+import * as fs from 'fs';
+
+/*
+  E0 Bank Switching ROM
+
+  An 8K ROM in Parker Brothers' E0 scheme: eight 1K banks. The ROM window is split into
+  four 1K slots. Slot 3 ($FC00-$FFFF) always shows bank 7, and the others are selected by
+  accessing $1FE0-$1FE7 (slot 0), $1FE8-$1FEF (slot 1) or $1FF0-$1FF7 (slot 2).
+
+  The visible-line loop runs straight across the boundary between slot 0 and slot 1. Slot 0
+  always shows bank 0. Slot 1 shows bank 1 on even frames and bank 3 on odd frames, and
+  the two banks EOR the line colour with different values. Bank 1 follows bank 0 in the ROM,
+  so on even frames the loop's bytes are contiguous in the ROM image. A core that caches code
+  across the slot boundary (as the block recompiler once did) keeps drawing bank 1's colours
+  on odd frames.
+
+  1. **Reset ($FC00, bank 7):**
+     Clears RAM and the stack and maps bank 0 into slot 0 and bank 1 into slot 1.
+
+  2. **Frame ($FC14, bank 7):**
+     Three lines of VSYNC and 37 of VBLANK, then JSR $F3F2 for the 192 visible lines, then
+     30 lines of overscan. Finally it increments the frame counter at $80 and selects
+     bank 1 or bank 3 for slot 1 by its lowest bit.
+
+  3. **Visible lines ($F3F2, bank 0, running into $F400 in slot 1):**
+     Each line waits for WSYNC, then computes the line number plus the frame counter. It
+     pads with NOPs up to the slot boundary, EORs with the slot 1 bank's value ($00 in
+     bank 1, $F0 in bank 3) and writes the result to COLUBK.
+*/
+
+const fixedBank = [
+  // Reset
+  0x78,             // FC00 SEI
+  0xD8,             // FC01 CLD
+  0xA2, 0xFF,       // FC02 LDX #$FF
+  0x9A,             // FC04 TXS
+  0xA9, 0x00,       // FC05 LDA #$00
+  0xA2, 0x7F,       // FC07 LDX #$7F
+  0x95, 0x80,       // FC09 STA $80,X   — Clear RAM.
+  0xCA,             // FC0B DEX
+  0x10, 0xFB,       // FC0C BPL $FC09
+  0xAD, 0xE0, 0x1F, // FC0E LDA $1FE0   — Slot 0: bank 0.
+  0xAD, 0xE9, 0x1F, // FC11 LDA $1FE9   — Slot 1: bank 1.
+  // VSYNC
+  0xA9, 0x02,       // FC14 LDA #$02
+  0x85, 0x02,       // FC16 STA WSYNC
+  0x85, 0x00,       // FC18 STA VSYNC
+  0x85, 0x02,       // FC1A STA WSYNC
+  0x85, 0x02,       // FC1C STA WSYNC
+  0x85, 0x02,       // FC1E STA WSYNC
+  0xA9, 0x00,       // FC20 LDA #$00
+  0x85, 0x00,       // FC22 STA VSYNC
+  // VBLANK
+  0xA2, 0x25,       // FC24 LDX #37
+  0x85, 0x02,       // FC26 STA WSYNC
+  0xCA,             // FC28 DEX
+  0xD0, 0xFB,       // FC29 BNE $FC26
+  0x86, 0x01,       // FC2B STX VBLANK  — X is 0: the picture starts.
+  // Visible lines
+  0xA0, 0xC0,       // FC2D LDY #192
+  0x20, 0xF2, 0xF3, // FC2F JSR $F3F2
+  // Overscan
+  0xA9, 0x02,       // FC32 LDA #$02
+  0x85, 0x01,       // FC34 STA VBLANK
+  0xA2, 0x1E,       // FC36 LDX #30
+  0x85, 0x02,       // FC38 STA WSYNC
+  0xCA,             // FC3A DEX
+  0xD0, 0xFB,       // FC3B BNE $FC38
+  // Next frame: slot 1 shows bank 1 on even frames and bank 3 on odd ones.
+  0xE6, 0x80,       // FC3D INC $80
+  0xA5, 0x80,       // FC3F LDA $80
+  0x29, 0x01,       // FC41 AND #$01
+  0xD0, 0x06,       // FC43 BNE $FC4B
+  0xAD, 0xE9, 0x1F, // FC45 LDA $1FE9   — Slot 1: bank 1.
+  0x4C, 0x14, 0xFC, // FC48 JMP $FC14
+  0xAD, 0xEB, 0x1F, // FC4B LDA $1FEB   — Slot 1: bank 3.
+  0x4C, 0x14, 0xFC, // FC4E JMP $FC14
+];
+
+// The end of bank 0, at $F3F2-$F3FF in slot 0.
+const linesStart = [
+  0x85, 0x02,       // F3F2 STA WSYNC
+  0x98,             // F3F4 TYA
+  0x65, 0x80,       // F3F5 ADC $80     — Line number plus frame counter.
+  0xEA, 0xEA, 0xEA, // F3F7 NOP ×9      — Up to the slot boundary.
+  0xEA, 0xEA, 0xEA,
+  0xEA, 0xEA, 0xEA,
+];
+
+// The start of banks 1 and 3, at $F400 in slot 1.
+function linesEnd(colorMask) {
+  return [
+    0x49, colorMask,  // F400 EOR #mask   — Differs per bank.
+    0x85, 0x09,       // F402 STA COLUBK
+    0x88,             // F404 DEY
+    0xD0, 0xEB,       // F405 BNE $F3F2
+    0x60,             // F407 RTS
+  ];
+}
+
+const bankSize = 1024;
+const romBuffer = Buffer.alloc(8 * bankSize, 0);
+
+romBuffer.set(linesStart, 0 * bankSize + 0x3F2);
+romBuffer.set(linesEnd(0x00), 1 * bankSize);
+romBuffer.set(linesEnd(0xF0), 3 * bankSize);
+romBuffer.set(fixedBank, 7 * bankSize);
+
+// Reset and IRQ vectors ($FFFC and $FFFE, the end of bank 7): $FC00.
+romBuffer[8 * bankSize - 4] = 0x00;
+romBuffer[8 * bankSize - 3] = 0xFC;
+romBuffer[8 * bankSize - 2] = 0x00;
+romBuffer[8 * bankSize - 1] = 0xFC;
+
+fs.writeFileSync('./roms/atari2600/6 - bank switching - E0.a26', romBuffer);
+console.log(`Wrote ${romBuffer.length} bytes to 6 - bank switching - E0.a26`);
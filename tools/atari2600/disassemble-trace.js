@@ -0,0 +1,139 @@
+import * as fs from 'fs';
+
+/*
+  Atari 2600 Trace Disassembler
+
+  Formats an instruction trace recorded by the trace build of the core as a listing, one
+  line per instruction with the registers before it ran.
+
+  Usage:
+    node tools/atari2600/disassemble-trace.js <trace> [output.txt]
+
+  Getting a trace:
+    yarn build:atari2600:trace   (builds the core with -DATARI2600_TRACE)
+  then run the emulator and press "Save trace", which downloads atari2600.trace. The core
+  keeps the last 65536 instructions; saving clears the buffer. Turn run-ahead off while
+  tracing, or the speculative frames are recorded too.
+
+  The trace is an array of 24-byte little-endian records (TraceRecord in
+  wasm/atari2600/trace.h):
+    0  u64  cycle      CPU cycle before the instruction
+    8  u16  pc
+    10 u8[3] bytes     Opcode and operand bytes
+    13 u8   A, X, Y, P, SP
+    18 u8[6] reserved
+*/
+
+const RECORD_SIZE = 24;
+
+// Operand formats of the addressing modes, with the number of operand bytes.
+const MODES = {
+  imp: { size: 0, format: () => '' },
+  acc: { size: 0, format: () => 'A' },
+  imm: { size: 1, format: (v) => `#$${hex(v, 2)}` },
+  zp:  { size: 1, format: (v) => `$${hex(v, 2)}` },
+  zpx: { size: 1, format: (v) => `$${hex(v, 2)},X` },
+  zpy: { size: 1, format: (v) => `$${hex(v, 2)},Y` },
+  abs: { size: 2, format: (v) => `$${hex(v, 4)}` },
+  abx: { size: 2, format: (v) => `$${hex(v, 4)},X` },
+  aby: { size: 2, format: (v) => `$${hex(v, 4)},Y` },
+  ind: { size: 2, format: (v) => `($${hex(v, 4)})` },
+  izx: { size: 1, format: (v) => `($${hex(v, 2)},X)` },
+  izy: { size: 1, format: (v) => `($${hex(v, 2)}),Y` },
+  rel: { size: 1, format: (v, pc) => `$${hex((pc + 2 + ((v << 24) >> 24)) & 0xFFFF, 4)}` },
+};
+
+// Mnemonic and addressing mode of each opcode, as in OPCODES in wasm/atari2600/opcodes.h.
+// Undocumented opcodes use the names of the NMOS 6502 references (LAX, SAX, DCP, ISB, ...).
+const OPCODES = {
+  0x00: 'BRK imp', 0x01: 'ORA izx', 0x02: 'JAM imp', 0x03: 'SLO izx', 0x04: 'NOP zp', 0x05: 'ORA zp',
+  0x06: 'ASL zp', 0x07: 'SLO zp', 0x08: 'PHP imp', 0x09: 'ORA imm', 0x0A: 'ASL acc', 0x0B: 'ANC imm',
+  0x0C: 'NOP abs', 0x0D: 'ORA abs', 0x0E: 'ASL abs', 0x0F: 'SLO abs', 0x10: 'BPL rel', 0x11: 'ORA izy',
+  0x12: 'JAM imp', 0x13: 'SLO izy', 0x14: 'NOP zpx', 0x15: 'ORA zpx', 0x16: 'ASL zpx', 0x17: 'SLO zpx',
+  0x18: 'CLC imp', 0x19: 'ORA aby', 0x1A: 'NOP imp', 0x1B: 'SLO aby', 0x1C: 'NOP abx', 0x1D: 'ORA abx',
+  0x1E: 'ASL abx', 0x1F: 'SLO abx', 0x20: 'JSR abs', 0x21: 'AND izx', 0x22: 'JAM imp', 0x23: 'RLA izx',
+  0x24: 'BIT zp', 0x25: 'AND zp', 0x26: 'ROL zp', 0x27: 'RLA zp', 0x28: 'PLP imp', 0x29: 'AND imm',
+  0x2A: 'ROL acc', 0x2B: 'ANC imm', 0x2C: 'BIT abs', 0x2D: 'AND abs', 0x2E: 'ROL abs', 0x2F: 'RLA abs',
+  0x30: 'BMI rel', 0x31: 'AND izy', 0x32: 'JAM imp', 0x33: 'RLA izy', 0x34: 'NOP zpx', 0x35: 'AND zpx',
+  0x36: 'ROL zpx', 0x37: 'RLA zpx', 0x38: 'SEC imp', 0x39: 'AND aby', 0x3A: 'NOP imp', 0x3B: 'RLA aby',
+  0x3C: 'NOP abx', 0x3D: 'AND abx', 0x3E: 'ROL abx', 0x3F: 'RLA abx', 0x40: 'RTI imp', 0x41: 'EOR izx',
+  0x42: 'JAM imp', 0x43: 'SRE izx', 0x44: 'NOP zp', 0x45: 'EOR zp', 0x46: 'LSR zp', 0x47: 'SRE zp',
+  0x48: 'PHA imp', 0x49: 'EOR imm', 0x4A: 'LSR acc', 0x4B: 'ALR imm', 0x4C: 'JMP abs', 0x4D: 'EOR abs',
+  0x4E: 'LSR abs', 0x4F: 'SRE abs', 0x50: 'BVC rel', 0x51: 'EOR izy', 0x52: 'JAM imp', 0x53: 'SRE izy',
+  0x54: 'NOP zpx', 0x55: 'EOR zpx', 0x56: 'LSR zpx', 0x57: 'SRE zpx', 0x58: 'CLI imp', 0x59: 'EOR aby',
+  0x5A: 'NOP imp', 0x5B: 'SRE aby', 0x5C: 'NOP abx', 0x5D: 'EOR abx', 0x5E: 'LSR abx', 0x5F: 'SRE abx',
+  0x60: 'RTS imp', 0x61: 'ADC izx', 0x62: 'JAM imp', 0x63: 'RRA izx', 0x64: 'NOP zp', 0x65: 'ADC zp',
+  0x66: 'ROR zp', 0x67: 'RRA zp', 0x68: 'PLA imp', 0x69: 'ADC imm', 0x6A: 'ROR acc', 0x6B: 'ARR imm',
+  0x6C: 'JMP ind', 0x6D: 'ADC abs', 0x6E: 'ROR abs', 0x6F: 'RRA abs', 0x70: 'BVS rel', 0x71: 'ADC izy',
+  0x72: 'JAM imp', 0x73: 'RRA izy', 0x74: 'NOP zpx', 0x75: 'ADC zpx', 0x76: 'ROR zpx', 0x77: 'RRA zpx',
+  0x78: 'SEI imp', 0x79: 'ADC aby', 0x7A: 'NOP imp', 0x7B: 'RRA aby', 0x7C: 'NOP abx', 0x7D: 'ADC abx',
+  0x7E: 'ROR abx', 0x7F: 'RRA abx', 0x80: 'NOP imm', 0x81: 'STA izx', 0x82: 'NOP imm', 0x83: 'SAX izx',
+  0x84: 'STY zp', 0x85: 'STA zp', 0x86: 'STX zp', 0x87: 'SAX zp', 0x88: 'DEY imp', 0x89: 'NOP imm',
+  0x8A: 'TXA imp', 0x8B: 'ANE imm', 0x8C: 'STY abs', 0x8D: 'STA abs', 0x8E: 'STX abs', 0x8F: 'SAX abs',
+  0x90: 'BCC rel', 0x91: 'STA izy', 0x92: 'JAM imp', 0x93: 'SHA izy', 0x94: 'STY zpx', 0x95: 'STA zpx',
+  0x96: 'STX zpy', 0x97: 'SAX zpy', 0x98: 'TYA imp', 0x99: 'STA aby', 0x9A: 'TXS imp', 0x9B: 'TAS aby',
+  0x9C: 'SHY abx', 0x9D: 'STA abx', 0x9E: 'SHX aby', 0x9F: 'SHA aby', 0xA0: 'LDY imm', 0xA1: 'LDA izx',
+  0xA2: 'LDX imm', 0xA3: 'LAX izx', 0xA4: 'LDY zp', 0xA5: 'LDA zp', 0xA6: 'LDX zp', 0xA7: 'LAX zp',
+  0xA8: 'TAY imp', 0xA9: 'LDA imm', 0xAA: 'TAX imp', 0xAB: 'LXA imm', 0xAC: 'LDY abs', 0xAD: 'LDA abs',
+  0xAE: 'LDX abs', 0xAF: 'LAX abs', 0xB0: 'BCS rel', 0xB1: 'LDA izy', 0xB2: 'JAM imp', 0xB3: 'LAX izy',
+  0xB4: 'LDY zpx', 0xB5: 'LDA zpx', 0xB6: 'LDX zpy', 0xB7: 'LAX zpy', 0xB8: 'CLV imp', 0xB9: 'LDA aby',
+  0xBA: 'TSX imp', 0xBB: 'LAS aby', 0xBC: 'LDY abx', 0xBD: 'LDA abx', 0xBE: 'LDX aby', 0xBF: 'LAX aby',
+  0xC0: 'CPY imm', 0xC1: 'CMP izx', 0xC2: 'NOP imm', 0xC3: 'DCP izx', 0xC4: 'CPY zp', 0xC5: 'CMP zp',
+  0xC6: 'DEC zp', 0xC7: 'DCP zp', 0xC8: 'INY imp', 0xC9: 'CMP imm', 0xCA: 'DEX imp', 0xCB: 'SBX imm',
+  0xCC: 'CPY abs', 0xCD: 'CMP abs', 0xCE: 'DEC abs', 0xCF: 'DCP abs', 0xD0: 'BNE rel', 0xD1: 'CMP izy',
+  0xD2: 'JAM imp', 0xD3: 'DCP izy', 0xD4: 'NOP zpx', 0xD5: 'CMP zpx', 0xD6: 'DEC zpx', 0xD7: 'DCP zpx',
+  0xD8: 'CLD imp', 0xD9: 'CMP aby', 0xDA: 'NOP imp', 0xDB: 'DCP aby', 0xDC: 'NOP abx', 0xDD: 'CMP abx',
+  0xDE: 'DEC abx', 0xDF: 'DCP abx', 0xE0: 'CPX imm', 0xE1: 'SBC izx', 0xE2: 'NOP imm', 0xE3: 'ISB izx',
+  0xE4: 'CPX zp', 0xE5: 'SBC zp', 0xE6: 'INC zp', 0xE7: 'ISB zp', 0xE8: 'INX imp', 0xE9: 'SBC imm',
+  0xEA: 'NOP imp', 0xEB: 'SBC imm', 0xEC: 'CPX abs', 0xED: 'SBC abs', 0xEE: 'INC abs', 0xEF: 'ISB abs',
+  0xF0: 'BEQ rel', 0xF1: 'SBC izy', 0xF2: 'JAM imp', 0xF3: 'ISB izy', 0xF4: 'NOP zpx', 0xF5: 'SBC zpx',
+  0xF6: 'INC zpx', 0xF7: 'ISB zpx', 0xF8: 'SED imp', 0xF9: 'SBC aby', 0xFA: 'NOP imp', 0xFB: 'ISB aby',
+  0xFC: 'NOP abx', 0xFD: 'SBC abx', 0xFE: 'INC abx', 0xFF: 'ISB abx',
+};
+
+const hex = (value, digits) => value.toString(16).toUpperCase().padStart(digits, '0');
+
+// NV-BDIZC, upper case for set flags.
+const flags = (p) => [...'NV-BDIZC'].map((name, i) => (p & (0x80 >> i) ? name : name.toLowerCase())).join('');
+
+function disassemble(bytes, pc) {
+  const entry = OPCODES[bytes[0]];
+  if (!entry) return { size: 1, text: `??? ($${hex(bytes[0], 2)})` };
+  const [mnemonic, modeName] = entry.split(' ');
+  const mode = MODES[modeName];
+  const value = mode.size === 2 ? bytes[1] | (bytes[2] << 8) : bytes[1];
+  return { size: 1 + mode.size, text: `${mnemonic} ${mode.format(value, pc)}`.trimEnd() };
+}
+
+const [tracePath, outPath] = process.argv.slice(2);
+if (!tracePath) {
+  console.error('Usage: node tools/atari2600/disassemble-trace.js <trace> [output.txt]');
+  process.exit(1);
+}
+
+const data = fs.readFileSync(tracePath);
+if (data.length % RECORD_SIZE !== 0) {
+  console.error(`Warning: trace size (${data.length} bytes) is not a multiple of ${RECORD_SIZE}; ignoring the tail.`);
+}
+
+const lines = [];
+for (let offset = 0; offset + RECORD_SIZE <= data.length; offset += RECORD_SIZE) {
+  const cycle = data.readBigUInt64LE(offset);
+  const pc = data.readUInt16LE(offset + 8);
+  const bytes = [...data.subarray(offset + 10, offset + 13)];
+  const [a, x, y, p, sp] = data.subarray(offset + 13, offset + 18);
+  const { size, text } = disassemble(bytes, pc);
+  const raw = bytes.slice(0, size).map((b) => hex(b, 2)).join(' ');
+  lines.push(
+    `${cycle.toString().padStart(10)}  ${hex(pc, 4)}  ${raw.padEnd(8)}  ${text.padEnd(14)}` +
+    `  A=${hex(a, 2)} X=${hex(x, 2)} Y=${hex(y, 2)} P=${flags(p)} SP=${hex(sp, 2)}`
+  );
+}
+
+const output = lines.join('\n') + '\n';
+if (outPath) {
+  fs.writeFileSync(outPath, output);
+  console.log(`Wrote ${lines.length} instructions to ${outPath}`);
+} else {
+  process.stdout.write(output);
+}
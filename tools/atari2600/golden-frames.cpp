@@ -0,0 +1,73 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// ----- Headless Frame Hasher -----
+// The native side of golden-frames.js. Links against the core in wasm/atari2600 and runs
+// each ROM for a number of frames, printing a hash of the screen after every frame:
+//
+//   <rom path>\t<hash> <hash> ...
+//
+// Hashes are 32-bit FNV-1a over the screen buffer, in hex. golden-frames.js computes the
+// same hash over the wasm core's screen.
+//
+// Usage: golden-frames <frames> <rom>...
+
+struct FrameStatus;
+
+extern "C"
+{
+  void init();
+  void loadProgram(uint8_t *romData, int size);
+  FrameStatus *runFrame();
+  uint8_t *getScreen();
+  int getScreenWidth();
+  int getScreenHeight();
+}
+
+static uint32_t hashScreen(const uint8_t *screen, int size)
+{
+  uint32_t hash = 2166136261u;
+  for (int i = 0; i < size; i++)
+  {
+    hash ^= screen[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 3)
+  {
+    fprintf(stderr, "Usage: %s <frames> <rom>...\n", argv[0]);
+    return 2;
+  }
+  int frames = atoi(argv[1]);
+  int screenSize = getScreenWidth() * getScreenHeight();
+
+  for (int i = 2; i < argc; i++)
+  {
+    FILE *file = fopen(argv[i], "rb");
+    if (!file)
+    {
+      fprintf(stderr, "Cannot open %s\n", argv[i]);
+      return 1;
+    }
+    std::vector<uint8_t> rom(64 * 1024);
+    int size = static_cast<int>(fread(rom.data(), 1, rom.size(), file));
+    fclose(file);
+
+    init();
+    loadProgram(rom.data(), size);
+    printf("%s\t", argv[i]);
+    for (int frame = 0; frame < frames; frame++)
+    {
+      runFrame();
+      printf(frame ? " %08x" : "%08x", hashScreen(getScreen(), screenSize));
+    }
+    printf("\n");
+  }
+  return 0;
+}
@@ -0,0 +1,246 @@
+import * as fs from 'fs';
+import * as os from 'os';
+import * as path from 'path';
+import * as vm from 'vm';
+import { execFileSync } from 'child_process';
+import { createRequire } from 'module';
+import { fileURLToPath } from 'url';
+
+/*
+  Atari 2600 Golden-Frame Test
+
+  Builds the test ROMs with the generator scripts in this directory ("1 - redscreen.js",
+  ...), runs each one for a number of frames in the native and the wasm build of the core,
+  and compares a hash of the screen after every frame with the values stored in
+  golden-frames.json. Any change to what the core draws shows up as the first frame
+  whose hash differs.
+
+  Usage:
+    node tools/atari2600/golden-frames.js [--update] [--core=native|wasm] [--frames=N]
+
+    --update        Record the native core's hashes as the new golden values. Do this
+                    only after checking that a change in the picture is intended.
+    --core=...      Run one core only. By default both run.
+    --frames=N      Frames per ROM (default: as many as were recorded).
+
+  The native core is compiled from wasm/atari2600/*.cpp together with golden-frames.cpp,
+  using $CXX (default c++), and cached in the system's temporary directory until a source
+  file changes. The wasm core is public/atari2600.js as built by `yarn build:atari2600`.
+  It also runs translated blocks (wasm/atari2600/recompiler.h), which the native core
+  cannot load, so the two together check the recompiler against the interpreter. A
+  missing build, or one older than the sources, fails the test; pass --core=native to
+  check the native core alone.
+
+  Hashes are 32-bit FNV-1a over the screen buffer (one colour register value per pixel),
+  so they do not depend on the palette. golden-frames.json stores them run-length
+  encoded, as [hash, frame count] pairs, since test ROMs repeat frames a lot.
+*/
+
+const TOOLS_DIR = path.dirname(fileURLToPath(import.meta.url));
+const ROOT = path.resolve(TOOLS_DIR, '../..');
+const CORE_DIR = path.join(ROOT, 'wasm/atari2600');
+const WASM_JS = path.join(ROOT, 'public/atari2600.js');
+const GOLDEN_FILE = path.join(TOOLS_DIR, 'golden-frames.json');
+const WORK_DIR = path.join(os.tmpdir(), 'atari2600-golden-frames');
+const DEFAULT_FRAMES = 1000;
+
+const args = process.argv.slice(2);
+const update = args.includes('--update');
+const coreArg = args.find((arg) => arg.startsWith('--core='));
+const framesArg = args.find((arg) => arg.startsWith('--frames='));
+const cores = coreArg ? [coreArg.slice('--core='.length)] : ['native', 'wasm'];
+
+// ----- ROMs -----
+
+// Run the generator scripts. They write to ./roms/atari2600/, so they run in WORK_DIR to
+// keep the output out of the repository. Returns { name: ROM path }.
+function buildRoms() {
+  const romDir = path.join(WORK_DIR, 'roms/atari2600');
+  fs.mkdirSync(romDir, { recursive: true });
+  const roms = {};
+  for (const script of fs.readdirSync(TOOLS_DIR).filter((file) => /^\d+ - .*\.js$/.test(file)).sort()) {
+    execFileSync(process.execPath, [path.join(TOOLS_DIR, script)], { cwd: WORK_DIR, stdio: 'ignore' });
+    const name = script.slice(0, -'.js'.length);
+    roms[name] = path.join(romDir, `${name}.a26`);
+  }
+  return roms;
+}
+
+// ----- Hashing -----
+
+function hashScreen(screen) {
+  let hash = 2166136261;
+  for (let i = 0; i < screen.length; i++) {
+    hash ^= screen[i];
+    hash = Math.imul(hash, 16777619);
+  }
+  return (hash >>> 0).toString(16).padStart(8, '0');
+}
+
+function encodeRuns(hashes) {
+  const runs = [];
+  for (const hash of hashes) {
+    if (runs.length && runs[runs.length - 1][0] === hash) runs[runs.length - 1][1]++;
+    else runs.push([hash, 1]);
+  }
+  return runs;
+}
+
+// JSON with one run per line, which keeps diffs of golden-frames.json readable.
+function formatGolden(frames, runs) {
+  const roms = Object.entries(runs).map(
+    ([name, list]) => `    ${JSON.stringify(name)}: [\n${list.map((run) => `      ${JSON.stringify(run)}`).join(',\n')}\n    ]`,
+  );
+  return `{\n  "frames": ${frames},\n  "roms": {\n${roms.join(',\n')}\n  }\n}\n`;
+}
+
+function decodeRuns(runs) {
+  return runs.flatMap(([hash, count]) => Array(count).fill(hash));
+}
+
+// ----- Native Core -----
+
+function newestSource(extra = []) {
+  const sources = fs.readdirSync(CORE_DIR).map((file) => path.join(CORE_DIR, file));
+  return Math.max(...[...sources, ...extra].map((file) => fs.statSync(file).mtimeMs));
+}
+
+function buildNative() {
+  const binary = path.join(WORK_DIR, 'golden-frames');
+  const driver = path.join(TOOLS_DIR, 'golden-frames.cpp');
+  if (fs.existsSync(binary) && fs.statSync(binary).mtimeMs > newestSource([driver])) return binary;
+
+  const sources = fs.readdirSync(CORE_DIR).filter((file) => file.endsWith('.cpp')).map((file) => path.join(CORE_DIR, file));
+  console.log('Compiling the native core...');
+  execFileSync(process.env.CXX || 'c++', ['-std=c++17', '-O2', '-o', binary, driver, ...sources], {
+    stdio: 'inherit',
+  });
+  return binary;
+}
+
+// Returns { name: [hash per frame] }.
+function runNative(roms, frames) {
+  const binary = buildNative();
+  const names = Object.keys(roms);
+  const output = execFileSync(binary, [String(frames), ...names.map((name) => roms[name])], { encoding: 'utf8' });
+  const lines = output.trim().split('\n');
+  return Object.fromEntries(names.map((name, i) => [name, lines[i].split('\t')[1].split(' ')]));
+}
+
+// ----- Wasm Core -----
+
+// Load the Emscripten glue the way the browser does, as a classic script with a global
+// Module. Throws if there is no build, or it does not match the sources.
+async function loadWasm() {
+  const rebuild = 'run yarn build:atari2600, or pass --core=native';
+  if (!fs.existsSync(WASM_JS)) throw new Error(`public/atari2600.js is missing; ${rebuild}`);
+  if (fs.statSync(WASM_JS).mtimeMs < newestSource()) throw new Error(`public/atari2600.js is older than wasm/atari2600; ${rebuild}`);
+
+  const Module = { print: () => {}, printErr: (text) => console.error(text) };
+  const ready = new Promise((resolve) => (Module.onRuntimeInitialized = resolve));
+  Object.assign(globalThis, {
+    Module,
+    require: createRequire(WASM_JS),
+    __dirname: path.dirname(WASM_JS),
+    __filename: WASM_JS,
+  });
+  vm.runInThisContext(fs.readFileSync(WASM_JS, 'utf8'), { filename: WASM_JS });
+  await ready;
+  if (!Module._runFrame) throw new Error(`public/atari2600.js predates runFrame(); ${rebuild}`);
+  return Module;
+}
+
+function runWasm(Module, roms, frames) {
+  const results = {};
+  const screenSize = Module._getScreenWidth() * Module._getScreenHeight();
+  for (const [name, file] of Object.entries(roms)) {
+    const rom = fs.readFileSync(file);
+    const ptr = Module._malloc(rom.length);
+    Module.HEAPU8.set(rom, ptr);
+    Module._init();
+    Module._loadProgram(ptr, rom.length);
+    Module._free(ptr);
+
+    const hashes = [];
+    for (let frame = 0; frame < frames; frame++) {
+      Module._runFrame();
+      const screenPtr = Module._getScreen();
+      hashes.push(hashScreen(Module.HEAPU8.subarray(screenPtr, screenPtr + screenSize)));
+    }
+    results[name] = hashes;
+  }
+  return results;
+}
+
+// ----- Main -----
+
+// Print the first differing frame of each ROM. Returns the number of failing ROMs.
+function compare(core, golden, actual) {
+  let failures = 0;
+  for (const [name, hashes] of Object.entries(actual)) {
+    const expected = golden[name] ? decodeRuns(golden[name]) : null;
+    if (!expected) {
+      console.log(`  ${core}: ${name}: no golden values (run with --update)`);
+      failures++;
+      continue;
+    }
+    const frame = hashes.findIndex((hash, i) => hash !== expected[i]);
+    if (frame >= 0) {
+      console.log(`  ${core}: ${name}: frame ${frame} is ${hashes[frame]}, expected ${expected[frame] ?? 'nothing'}`);
+      failures++;
+    }
+  }
+  return failures;
+}
+
+async function main() {
+  const golden = fs.existsSync(GOLDEN_FILE) ? JSON.parse(fs.readFileSync(GOLDEN_FILE, 'utf8')) : { frames: 0, roms: {} };
+  const frames = framesArg ? Number(framesArg.slice('--frames='.length)) : golden.frames || DEFAULT_FRAMES;
+  const roms = buildRoms();
+
+  if (update) {
+    const hashes = runNative(roms, frames);
+    const runs = Object.fromEntries(Object.entries(hashes).map(([name, list]) => [name, encodeRuns(list)]));
+    fs.writeFileSync(GOLDEN_FILE, formatGolden(frames, runs));
+    console.log(`Recorded ${frames} frames of ${Object.keys(roms).length} ROMs in ${path.relative(ROOT, GOLDEN_FILE)}`);
+    return;
+  }
+
+  if (frames > golden.frames) {
+    console.log(`Only ${golden.frames} frames are recorded; run with --update --frames=${frames} first.`);
+    process.exit(1);
+  }
+
+  let failures = 0;
+  for (const core of cores) {
+    let start = performance.now();
+    let actual;
+    if (core === 'native') {
+      buildNative();
+      start = performance.now();
+      actual = runNative(roms, frames);
+    } else if (core === 'wasm') {
+      let Module;
+      try {
+        Module = await loadWasm();
+      } catch (error) {
+        console.log(`wasm: ${error.message}`);
+        failures++;
+        continue;
+      }
+      start = performance.now();
+      actual = runWasm(Module, roms, frames);
+    } else {
+      console.log(`Unknown core "${core}"`);
+      process.exit(2);
+    }
+    const total = frames * Object.keys(roms).length;
+    const ms = performance.now() - start;
+    const coreFailures = compare(core, golden.roms, actual);
+    console.log(`${core}: ${total} frames in ${ms.toFixed(0)} ms, ${coreFailures ? `${coreFailures} ROMs differ` : 'all match'}`);
+    failures += coreFailures;
+  }
+  process.exit(failures ? 1 : 0);
+}
+
+main();
@@ -0,0 +1,385 @@
+import * as fs from 'fs';
+import * as path from 'path';
+
+/*
+  Chip-8 Ahead-of-Time Translator
+
+  Statically disassembles a Chip-8 ROM and emits a C++ translation unit that, linked with the
+  interpreter in wasm/chip8/, produces a core specialised for that ROM.
+
+  Usage:
+    node tools/chip8/aot-translate.js <rom> [output.cpp]
+
+  The output defaults to wasm/chip8/aot/<rom name>.cpp. Build the specialised core with:
+    yarn build:chip8:aot wasm/chip8/aot/<rom name>.cpp -o ./public/chip8-<rom name>.js
+
+  How it works:
+  - Starting at the 0x200 entry point, the control-flow graph is recovered by following
+    fall-through, 1NNN jumps, 2NNN calls (and their return sites), and both successors of
+    every skip instruction. For BNNN, the jump table at NNN (a run of 1NNN instructions) is
+    followed entry by entry.
+  - Every jump target becomes a basic block with a label, so static jumps compile to gotos.
+    Dynamic transfers (00EE, BNNN) go through a switch on pc over all block entry points.
+  - Each instruction still costs one unit of the interpreter's per-frame instruction budget,
+    so the translated core runs at exactly the same speed (in instructions) as the interpreter.
+  - Anything the translator cannot handle falls back to the interpreter: a pc that is not a
+    block entry, unsupported opcodes, stack over/underflow, and blocks whose bytes were
+    overwritten at run time (self-modifying code, detected via aotInvalidate()).
+  - If the ROM loaded at run time differs from the one translated, the core uses only the
+    interpreter.
+*/
+
+const ENTRY = 0x200;
+const MEMORY_SIZE = 4096;
+const MAX_JUMP_TABLE_ENTRIES = 128;
+
+const hex = (value, digits = 3) => '0x' + value.toString(16).toUpperCase().padStart(digits, '0');
+const label = (addr) => `L_${addr.toString(16).toUpperCase().padStart(3, '0')}`;
+
+const [romPath, outArg] = process.argv.slice(2);
+if (!romPath) {
+  console.error('Usage: node tools/chip8/aot-translate.js <rom> [output.cpp]');
+  process.exit(1);
+}
+
+const rom = fs.readFileSync(romPath);
+const romEnd = Math.min(ENTRY + rom.length, MEMORY_SIZE);
+const romName = path.basename(romPath).replace(/\.[^.]*$/, '').replace(/[^A-Za-z0-9_-]+/g, '_');
+const outPath = outArg ?? path.join('wasm', 'chip8', 'aot', `${romName}.cpp`);
+
+const inRom = (addr) => addr >= ENTRY && addr + 1 < romEnd;
+const opcodeAt = (addr) => (rom[addr - ENTRY] << 8) | rom[addr - ENTRY + 1];
+
+/**
+ * Classifies an instruction for control-flow recovery.
+ * Mirrors the decoding in emulateCycle(), so anything the interpreter treats as
+ * unsupported is left to the interpreter here too.
+ *
+ * @returns {{ supported: boolean, ends: boolean, successors: number[] }}
+ *   ends: the instruction ends its basic block; successors: statically known next pcs.
+ */
+function classify(addr, op) {
+  const next = addr + 2;
+  const skip = { supported: true, ends: true, successors: [next, addr + 4] };
+  const plain = { supported: true, ends: false, successors: [next] };
+  const unsupported = { supported: false, ends: true, successors: [] };
+
+  switch (op & 0xF000) {
+    case 0x0000:
+      if (op === 0x00E0) return plain;
+      if (op === 0x00EE) return { supported: true, ends: true, successors: [] };
+      return unsupported;
+    case 0x1000:
+      return { supported: true, ends: true, successors: [op & 0x0FFF] };
+    case 0x2000:
+      return { supported: true, ends: true, successors: [op & 0x0FFF, next] };
+    case 0x3000:
+    case 0x4000:
+    case 0x5000:
+    case 0x9000:
+      return skip;
+    case 0x8000:
+      return [0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0xE].includes(op & 0x000F) ? plain : unsupported;
+    case 0xB000:
+      return { supported: true, ends: true, successors: jumpTable(op & 0x0FFF) };
+    case 0xE000:
+      return [0x9E, 0xA1].includes(op & 0x00FF) ? skip : unsupported;
+    case 0xF000:
+      if ((op & 0x00FF) === 0x0A) return { supported: true, ends: true, successors: [addr, next] };
+      return [0x02, 0x07, 0x15, 0x18, 0x1E, 0x29, 0x33, 0x3A, 0x55, 0x65].includes(op & 0x00FF) ? plain : unsupported;
+    default:
+      return plain; // 6XNN, 7XNN, ANNN, CXNN, DXYN
+  }
+}
+
+/**
+ * Resolves the targets of BNNN (jump to NNN + V0). The usual idiom is a table of
+ * 1NNN jumps at NNN indexed by an even V0, so every consecutive jump in the table is
+ * an entry. NNN itself is always included; other V0 values reach the interpreter.
+ */
+function jumpTable(base) {
+  const targets = [base];
+  for (let i = 0; i < MAX_JUMP_TABLE_ENTRIES; i++) {
+    const entry = base + i * 2;
+    if (!inRom(entry) || (opcodeAt(entry) & 0xF000) !== 0x1000) break;
+    targets.push(entry);
+  }
+  return targets;
+}
+
+/* ============================================================
+   Control-flow recovery
+============================================================ */
+
+const reached = new Map(); // addr -> classification
+const leaders = new Set([ENTRY]);
+const worklist = [ENTRY];
+
+while (worklist.length > 0) {
+  const addr = worklist.pop();
+  if (reached.has(addr) || !inRom(addr)) continue;
+  const info = classify(addr, opcodeAt(addr));
+  reached.set(addr, info);
+  for (const target of info.successors) {
+    if (info.ends) leaders.add(target);
+    worklist.push(target);
+  }
+}
+
+// Instructions that stall in place (Fx0A) loop back to themselves, so they are leaders too;
+// classify() already lists them as their own successor. Keep only leaders we can translate.
+const blockStarts = [...leaders].filter((addr) => reached.has(addr) && reached.get(addr).supported).sort((a, b) => a - b);
+const blockIndex = new Map(blockStarts.map((addr, i) => [addr, i]));
+
+const blocks = blockStarts.map((start) => {
+  const instructions = [];
+  let addr = start;
+  for (;;) {
+    const info = reached.get(addr);
+    if (!info || !info.supported) break;
+    instructions.push(addr);
+    if (info.ends) break;
+    addr += 2;
+    if (blockIndex.has(addr)) break;
+  }
+  const last = instructions[instructions.length - 1];
+  return { start, end: last + 2, instructions };
+});
+
+/* ============================================================
+   Code generation
+============================================================ */
+
+// Transfer control to a static target: a goto if it is a translated block, else hand
+// back to the interpreter.
+const jumpTo = (target) =>
+  blockIndex.has(target) ? `goto ${label(target)};` : `{ pc = ${hex(target)}; return budget; }`;
+
+/**
+ * Emits the C++ for one instruction. The semantics mirror emulateCycle() exactly.
+ */
+function emitInstruction(addr, op) {
+  const x = (op & 0x0F00) >> 8;
+  const y = (op & 0x00F0) >> 4;
+  const n = op & 0x000F;
+  const nn = hex(op & 0x00FF, 2);
+  const nnn = op & 0x0FFF;
+  const vx = `V[${hex(x, 1)}]`;
+  const vy = `V[${hex(y, 1)}]`;
+  const next = addr + 2;
+  const step = `STEP(${hex(addr)});`;
+  const skipIf = (cond) => [step, `if (${cond})`, `  ${jumpTo(addr + 4)}`, jumpTo(next)];
+  // After a memory write, leave the block if it overwrote translated code.
+  const afterWrite = `if (codeModified) { codeModified = false; pc = ${hex(next)}; goto dispatch; }`;
+
+  switch (op & 0xF000) {
+    case 0x0000:
+      if (op === 0x00E0) return [step, 'cls();'];
+      return [`if (sp == 0) { pc = ${hex(addr)}; return budget; }`, step, 'pc = stack[--sp];', 'goto dispatch;'];
+    case 0x1000:
+      return [step, jumpTo(nnn)];
+    case 0x2000:
+      return [`if (sp >= 16) { pc = ${hex(addr)}; return budget; }`, step, `stack[sp++] = ${hex(next)};`, jumpTo(nnn)];
+    case 0x3000:
+      return skipIf(`${vx} == ${nn}`);
+    case 0x4000:
+      return skipIf(`${vx} != ${nn}`);
+    case 0x5000:
+      return skipIf(`${vx} != ${vy}`); // Same condition as the interpreter's 5XY0.
+    case 0x6000:
+      return [step, `${vx} = ${nn};`];
+    case 0x7000:
+      return [step, `${vx} += ${nn};`];
+    case 0x8000:
+      switch (n) {
+        case 0x0: return [step, `${vx} = ${vy};`];
+        case 0x1: return [step, `${vx} |= ${vy};`];
+        case 0x2: return [step, `${vx} &= ${vy};`];
+        case 0x3: return [step, `${vx} ^= ${vy};`];
+        case 0x4: return [step, `{ uint16_t sum = ${vx} + ${vy}; V[0xF] = (sum > 0xFF) ? 1 : 0; ${vx} = sum & 0xFF; }`];
+        case 0x5: return [step, `V[0xF] = (${vx} > ${vy}) ? 1 : 0;`, `${vx} = ${vx} - ${vy};`];
+        case 0x6: return [step, `V[0xF] = ${vx} & 0x1;`, `${vx} >>= 1;`];
+        case 0x7: return [step, `V[0xF] = (${vy} > ${vx}) ? 1 : 0;`, `${vx} = ${vy} - ${vx};`];
+        default: return [step, `V[0xF] = (${vx} & 0x80) >> 7;`, `${vx} <<= 1;`]; // 0xE
+      }
+    case 0x9000:
+      return skipIf(`${vx} != ${vy}`);
+    case 0xA000:
+      return [step, `I = ${hex(nnn)};`];
+    case 0xB000:
+      return [step, `pc = ${hex(nnn)} + V[0x0];`, 'goto dispatch;'];
+    case 0xC000:
+      return [step, `${vx} = nextRandom() & ${nn};`];
+    case 0xD000:
+      return [step, `drawSprite(${vx}, ${vy}, ${n});`];
+    case 0xE000:
+      return skipIf((op & 0x00FF) === 0x9E ? `keys[${vx} & 0x0F]` : `!keys[${vx} & 0x0F]`);
+    default:
+      switch (op & 0x00FF) {
+        case 0x02: return [step, 'loadAudioPattern();'];
+        case 0x07: return [step, `${vx} = delayTimer;`];
+        case 0x0A: return [
+          step,
+          'for (int k = 0; k < 16; k++)',
+          '{',
+          '  if (keys[k])',
+          '  {',
+          `    ${vx} = k;`,
+          `    ${jumpTo(next)}`,
+          '  }',
+          '}',
+          `goto ${label(addr)}; // No key down: wait here, consuming budget like the interpreter.`,
+        ];
+        case 0x15: return [step, `delayTimer = ${vx};`];
+        case 0x18: return [step, `soundTimer = ${vx};`];
+        case 0x1E: return [step, `I += ${vx};`];
+        case 0x29: return [step, `I = 0x50 + (${vx} * 5);`];
+        case 0x33: return [
+          step,
+          `memory[I] = ${vx} / 100;`,
+          `memory[I + 1] = (${vx} / 10) % 10;`,
+          `memory[I + 2] = ${vx} % 10;`,
+          'aotInvalidate(I, 3);',
+          afterWrite,
+        ];
+        case 0x3A: return [step, `audioPitch = ${vx};`];
+        case 0x55: return [
+          step,
+          `for (int i = 0; i <= ${x}; i++)`,
+          '  memory[I + i] = V[i];',
+          `aotInvalidate(I, ${x + 1});`,
+          afterWrite,
+        ];
+        default: return [ // 0x65
+          step,
+          `for (int i = 0; i <= ${x}; i++)`,
+          '  V[i] = memory[I + i];',
+        ];
+      }
+  }
+}
+
+const includePath = path.relative(path.dirname(path.resolve(outPath)), path.resolve('wasm/chip8/chip8.h')).split(path.sep).join('/');
+
+const codeMap = new Uint8Array(MEMORY_SIZE / 8);
+for (const block of blocks) {
+  for (let addr = block.start; addr < block.end; addr++) {
+    codeMap[addr >> 3] |= 1 << (addr & 7);
+  }
+}
+
+const byteList = (bytes, perLine = 16) => {
+  const lines = [];
+  for (let i = 0; i < bytes.length; i += perLine) {
+    lines.push('    ' + [...bytes.subarray(i, i + perLine)].map((b) => hex(b, 2) + ',').join(' '));
+  }
+  return lines.join('\n');
+};
+
+const out = [];
+out.push(`// Generated by tools/chip8/aot-translate.js from ${path.basename(romPath)}. Do not edit.`);
+out.push(`// ${blocks.length} blocks, ${reached.size} reachable instructions.`);
+out.push('');
+out.push('#include <cstring>');
+out.push('');
+out.push(`#include "${includePath}"`);
+out.push('');
+out.push('// The ROM this unit was translated from; the translated code is only used for this ROM.');
+out.push(`static const uint8_t AOT_ROM[${rom.length}] = {`);
+out.push(byteList(rom));
+out.push('};');
+out.push('');
+out.push('// One bit per memory byte covered by a translated block.');
+out.push(`static const uint8_t CODE_MAP[${codeMap.length}] = {`);
+out.push(byteList(codeMap));
+out.push('};');
+out.push('');
+out.push('struct AotBlock');
+out.push('{');
+out.push('  uint16_t start, end; // Memory range [start, end) the block was translated from.');
+out.push('};');
+out.push('');
+out.push(`static const AotBlock BLOCKS[${blocks.length}] = {`);
+for (const block of blocks) {
+  out.push(`    {${hex(block.start)}, ${hex(block.end)}},`);
+}
+out.push('};');
+out.push('');
+out.push(`static bool blockValid[${blocks.length}];`);
+out.push('static bool aotEnabled = false;');
+out.push('static bool codeModified = false; // Set when a write invalidates a block.');
+out.push('');
+out.push('void aotAttach(const uint8_t *program, int size)');
+out.push('{');
+out.push('  aotEnabled = size == (int)sizeof(AOT_ROM) && memcmp(program, AOT_ROM, sizeof(AOT_ROM)) == 0;');
+out.push('  for (bool &valid : blockValid)');
+out.push('    valid = true;');
+out.push('}');
+out.push('');
+out.push('void aotInvalidate(uint16_t address, int length)');
+out.push('{');
+out.push('  bool hit = false;');
+out.push('  for (int a = address; a < address + length && a < 4096; a++)');
+out.push('    hit |= (CODE_MAP[a >> 3] >> (a & 7)) & 1;');
+out.push('  if (!hit)');
+out.push('    return;');
+out.push('  for (size_t i = 0; i < sizeof(BLOCKS) / sizeof(BLOCKS[0]); i++)');
+out.push('  {');
+out.push('    if (BLOCKS[i].start < address + length && address < BLOCKS[i].end)');
+out.push('    {');
+out.push('      blockValid[i] = false;');
+out.push('      codeModified = true;');
+out.push('    }');
+out.push('  }');
+out.push('}');
+out.push('');
+out.push('// Consume one instruction of budget, or stop before the instruction at `addr` if none is left.');
+out.push('#define STEP(addr)  \\');
+out.push('  if (budget == 0)  \\');
+out.push('  {                 \\');
+out.push('    pc = addr;      \\');
+out.push('    return 0;       \\');
+out.push('  }                 \\');
+out.push('  budget--;');
+out.push('');
+out.push('int aotExecute(int budget)');
+out.push('{');
+out.push('  if (!aotEnabled)');
+out.push('    return budget;');
+out.push('');
+out.push('dispatch:');
+out.push('  switch (pc)');
+out.push('  {');
+for (const block of blocks) {
+  out.push(`  case ${hex(block.start)}:`);
+  out.push(`    goto ${label(block.start)};`);
+}
+out.push('  default:');
+out.push('    return budget;');
+out.push('  }');
+blocks.forEach((block, i) => {
+  out.push('');
+  out.push(`${label(block.start)}:`);
+  out.push(`  if (!blockValid[${i}])`);
+  out.push('  {');
+  out.push(`    pc = ${hex(block.start)};`);
+  out.push('    return budget;');
+  out.push('  }');
+  for (const addr of block.instructions) {
+    const op = opcodeAt(addr);
+    out.push(`  // ${hex(addr)}: ${hex(op, 4)}`);
+    for (const line of emitInstruction(addr, op)) {
+      out.push('  ' + line);
+    }
+  }
+  const last = block.instructions[block.instructions.length - 1];
+  if (!reached.get(last).ends) {
+    out.push(`  ${jumpTo(block.end)}`);
+  }
+});
+out.push('}');
+out.push('');
+
+fs.mkdirSync(path.dirname(outPath), { recursive: true });
+fs.writeFileSync(outPath, out.join('\n'));
+console.log(`Translated ${reached.size} instructions in ${blocks.length} blocks to ${outPath}`);
@@ -1,7 +1,20 @@
 import { defineConfig } from 'vite'
 import { resolve } from 'path'
 
+// Cross-origin isolation is required for SharedArrayBuffer, which the cores use
+// to share their audio ring buffers with the AudioWorklet.
+const crossOriginIsolation = {
+  'Cross-Origin-Opener-Policy': 'same-origin',
+  'Cross-Origin-Embedder-Policy': 'require-corp'
+}
+
 export default defineConfig({
+  server: {
+    headers: crossOriginIsolation
+  },
+  preview: {
+    headers: crossOriginIsolation
+  },
   build: {
     rollupOptions: {
       input: {
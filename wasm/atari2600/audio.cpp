@@ -0,0 +1,217 @@
+#include <cstring>
+
+#include "audio.h"
+#include "cpu6502.h"
+
+TiaAudio tiaAudio;
+bool audioEnabled = true;
+uint64_t audioSamplesWritten = 0;
+
+// ----- Waveform Tables -----
+// The pulse and noise counters of a channel form 9 bits of state, and each AUDC value
+// defines one step function over them. The steps are tabulated once for all 16 AUDC
+// values, so a tick is a single lookup and switching AUDC mid-note keeps the counters,
+// as on the chip.
+
+const int AUDIO_STATES = 512;
+
+struct AudioTables
+{
+  uint16_t next[16][AUDIO_STATES];
+};
+
+// One tick of the counters, following the feedback logic of the TIA's audio circuit.
+static uint16_t stepState(int audc, uint16_t state)
+{
+  uint8_t pulse = state & 0x0F;
+  uint8_t noise = state >> 4;
+  bool noiseOut = noise & 0x01;
+
+  // Bits 0-1 pick what clocks the pulse counter: always, or only on some noise steps.
+  bool hold;
+  bool noiseFeedback;
+  switch (audc & 0x03)
+  {
+  case 0x00:
+    hold = false;
+    noiseFeedback = ((pulse ^ noise) & 0x01) || !(noise || pulse != 0x0A) || !(audc & 0x0C);
+    break;
+  case 0x01:
+    hold = false;
+    noiseFeedback = (((noise >> 2) ^ noise) & 0x01) || noise == 0;
+    break;
+  case 0x02:
+    // Div 31: clocked twice per noise period.
+    hold = (noise & 0x1E) != 0x02;
+    noiseFeedback = (((noise >> 2) ^ noise) & 0x01) || noise == 0;
+    break;
+  default:
+    // Clocked by the 5-bit polynomial.
+    hold = !noiseOut;
+    noiseFeedback = (((noise >> 2) ^ noise) & 0x01) || noise == 0;
+    break;
+  }
+
+  // Bits 2-3 pick the pulse counter's feedback: 4-bit polynomial, div 2, the 5-bit
+  // polynomial's output, or div 6.
+  bool pulseFeedback;
+  switch (audc >> 2)
+  {
+  case 0x00:
+    pulseFeedback = (((pulse >> 1) ^ pulse) & 0x01) && pulse != 0x0A && (audc & 0x03);
+    break;
+  case 0x01:
+    pulseFeedback = !(pulse & 0x08);
+    break;
+  case 0x02:
+    pulseFeedback = !noiseOut;
+    break;
+  default:
+    pulseFeedback = !((pulse & 0x02) || !(pulse & 0x0E));
+    break;
+  }
+
+  noise = (noise >> 1) | (noiseFeedback ? 0x10 : 0);
+  if (!hold)
+    pulse = (~(pulse >> 1) & 0x07) | (pulseFeedback ? 0x08 : 0);
+  return pulse | (noise << 4);
+}
+
+static AudioTables buildTables()
+{
+  AudioTables tables;
+  for (int audc = 0; audc < 16; audc++)
+    for (int state = 0; state < AUDIO_STATES; state++)
+      tables.next[audc][state] = stepState(audc, state);
+  return tables;
+}
+
+static const AudioTables &audioTables()
+{
+  // Built on first use: the 8192 steps are too many for a constexpr table in clang.
+  static const AudioTables TABLES = buildTables();
+  return TABLES;
+}
+
+// ----- Output -----
+// Host-side state: like the AudioRing it is not part of the emulated state.
+
+// Audio clock rate: the NTSC colour clock divided by 114.
+const double AUDIO_CLOCK_HZ = 3579545.0 / 114.0;
+const float AUDIO_VOLUME = 0.5f;
+
+static AudioRing audioRing;
+static int audioSampleRate = 0; // Host sample rate; 0 until audioStart() is called.
+
+// Resampler: each host sample is the average of the audio clock samples it covers.
+static double samplePeriod = 0; // Audio clocks per host sample
+static double sampleLeft = 0;   // Audio clocks still needed for the host sample being built
+static double sampleSum = 0;    // Sum of the audio clock samples so far, weighted by coverage
+static float dcInput = 0;       // Previous input and output of the DC-blocking filter
+static float dcOutput = 0;
+static float sampleBuffer[256];
+static int bufferedSamples = 0;
+
+static void flushSamples()
+{
+  audioRing.write(sampleBuffer, bufferedSamples);
+  audioSamplesWritten += bufferedSamples;
+  bufferedSamples = 0;
+}
+
+// Add one host sample. The TIA's output is never negative, so a one-pole high-pass filter
+// takes out the DC level before it reaches the speakers.
+static void emitSample(float value)
+{
+  dcOutput = value - dcInput + 0.995f * dcOutput;
+  dcInput = value;
+  sampleBuffer[bufferedSamples++] = dcOutput * AUDIO_VOLUME;
+  if (bufferedSamples == 256)
+    flushSamples();
+}
+
+// Feed one audio clock's worth of output, 0-1.
+static void resample(float value)
+{
+  double left = 1.0;
+  while (left >= sampleLeft)
+  {
+    sampleSum += value * sampleLeft;
+    left -= sampleLeft;
+    emitSample(static_cast<float>(sampleSum / samplePeriod));
+    sampleSum = 0;
+    sampleLeft = samplePeriod;
+  }
+  sampleSum += value * left;
+  sampleLeft -= left;
+}
+
+// ----- Synthesis -----
+
+static uint8_t tickChannel(AudioChannel &channel)
+{
+  if (channel.divider == channel.AUDF)
+  {
+    channel.divider = 0;
+    channel.state = audioTables().next[channel.AUDC][channel.state];
+  }
+  else
+    channel.divider = (channel.divider + 1) & 0x1F;
+  return (channel.state & 0x01) ? channel.AUDV : 0;
+}
+
+void audioCatchUp(uint64_t cycle)
+{
+  uint64_t target = cycle / CYCLES_PER_AUDIO_CLOCK;
+  if (!audioEnabled || audioSampleRate == 0)
+  {
+    tiaAudio.clock = target;
+    return;
+  }
+
+  for (; tiaAudio.clock < target; tiaAudio.clock++)
+  {
+    int level = tickChannel(tiaAudio.channels[0]) + tickChannel(tiaAudio.channels[1]);
+    resample(level / 30.0f);
+  }
+  flushSamples();
+}
+
+void audioReset()
+{
+  memset(&tiaAudio, 0, sizeof(tiaAudio));
+  tiaAudio.clock = cpu.cycles / CYCLES_PER_AUDIO_CLOCK;
+}
+
+void audioWriteControl(int channel, uint8_t value)
+{
+  audioCatchUp(cpu.cycles);
+  tiaAudio.channels[channel].AUDC = value & 0x0F;
+}
+
+void audioWriteFrequency(int channel, uint8_t value)
+{
+  audioCatchUp(cpu.cycles);
+  tiaAudio.channels[channel].AUDF = value & 0x1F;
+}
+
+void audioWriteVolume(int channel, uint8_t value)
+{
+  audioCatchUp(cpu.cycles);
+  tiaAudio.channels[channel].AUDV = value & 0x0F;
+}
+
+AudioRing *audioStart(int sampleRate)
+{
+  audioRing.reset();
+  audioSampleRate = sampleRate;
+  samplePeriod = AUDIO_CLOCK_HZ / sampleRate;
+  sampleLeft = samplePeriod;
+  sampleSum = 0;
+  dcInput = 0;
+  dcOutput = 0;
+  bufferedSamples = 0;
+  audioSamplesWritten = 0;
+  tiaAudio.clock = cpu.cycles / CYCLES_PER_AUDIO_CLOCK;
+  return &audioRing;
+}
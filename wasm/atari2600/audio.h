@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+#include "../common/audio_ring.h"
+
+// ----- TIA Audio -----
+// Each of the two channels divides the audio clock (two per scanline, about 31.4 kHz) by
+// AUDF + 1. On every divided tick its 4-bit pulse counter and 5-bit noise counter step
+// once; AUDC selects how they are fed back, which gives the pure tones, the 4-, 5- and
+// 9-bit polynomial noises and their combinations. The output is bit 0 of the pulse
+// counter, scaled by AUDV.
+//
+// Audio is synthesised lazily, like the picture: nothing happens while the CPU runs, and
+// before an audio register changes the output is brought up to date, one audio clock per
+// sample. The samples are resampled to the host rate into the shared AudioRing.
+
+// CPU cycles per audio clock: the TIA clocks its audio twice per scanline.
+const int CYCLES_PER_AUDIO_CLOCK = 38;
+
+struct AudioChannel
+{
+  uint8_t AUDC;    // Waveform (low 4 bits)
+  uint8_t AUDF;    // Frequency divider - 1 (low 5 bits)
+  uint8_t AUDV;    // Volume (low 4 bits)
+  uint8_t divider; // Audio clocks since the last tick
+  uint16_t state;  // Pulse counter in bits 0-3, noise counter in bits 4-8
+};
+
+struct TiaAudio
+{
+  AudioChannel channels[2];
+  uint64_t clock; // Audio clocks synthesised so far
+};
+
+extern TiaAudio tiaAudio;
+
+// When false, audio clocks are skipped instead of synthesised (used for frames that will
+// be rolled back).
+extern bool audioEnabled;
+
+// Host samples written to the AudioRing since audioStart().
+extern uint64_t audioSamplesWritten;
+
+void audioReset();
+
+// AUDC0/1, AUDF0/1 and AUDV0/1 writes, after catching up to the current cycle.
+void audioWriteControl(int channel, uint8_t value);
+void audioWriteFrequency(int channel, uint8_t value);
+void audioWriteVolume(int channel, uint8_t value);
+
+// Synthesise the audio clocks up to CPU cycle `cycle`.
+void audioCatchUp(uint64_t cycle);
+
+/**
+ * Start resampling to the host at `sampleRate` Hz.
+ *
+ * @return The ring the AudioWorklet drains.
+ */
+AudioRing *audioStart(int sampleRate);
@@ -0,0 +1,55 @@
+#include "bus.h"
+
+BusPage busPages[PAGE_COUNT] = {};
+
+uint8_t openBusRead(uint16_t address)
+{
+  (void)address;
+  return 0;
+}
+
+void openBusWrite(uint16_t address, uint8_t value)
+{
+  (void)address;
+  (void)value;
+}
+
+void busMapRead(uint16_t start, uint16_t size, uint8_t *memory)
+{
+  for (uint16_t offset = 0; offset < size; offset += PAGE_SIZE)
+  {
+    BusPage &page = busPages[((start + offset) & ADDRESS_MASK) >> PAGE_SHIFT];
+    page.read = memory + offset;
+    page.readHandler = openBusRead;
+  }
+}
+
+void busMapWrite(uint16_t start, uint16_t size, uint8_t *memory)
+{
+  for (uint16_t offset = 0; offset < size; offset += PAGE_SIZE)
+  {
+    BusPage &page = busPages[((start + offset) & ADDRESS_MASK) >> PAGE_SHIFT];
+    page.write = memory + offset;
+    page.writeHandler = openBusWrite;
+  }
+}
+
+void busMapReadHandler(uint16_t start, uint16_t size, ReadHandler handler)
+{
+  for (uint16_t offset = 0; offset < size; offset += PAGE_SIZE)
+  {
+    BusPage &page = busPages[((start + offset) & ADDRESS_MASK) >> PAGE_SHIFT];
+    page.read = nullptr;
+    page.readHandler = handler;
+  }
+}
+
+void busMapWriteHandler(uint16_t start, uint16_t size, WriteHandler handler)
+{
+  for (uint16_t offset = 0; offset < size; offset += PAGE_SIZE)
+  {
+    BusPage &page = busPages[((start + offset) & ADDRESS_MASK) >> PAGE_SHIFT];
+    page.write = nullptr;
+    page.writeHandler = handler;
+  }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+
+// ----- Memory Bus -----
+// The 6507 only has 13 address lines, so the 64 KB address space is eight mirrors of an
+// 8 KB bus. The bus is divided into 64-byte pages, the smallest block any 2600 device
+// decodes. A page either points straight at host memory (ROM and RAM), or routes accesses
+// to a handler (TIA, RIOT and bank-switching hotspots).
+
+const uint16_t ADDRESS_MASK = 0x1FFF;
+const int PAGE_SHIFT = 6;
+const uint16_t PAGE_SIZE = 1 << PAGE_SHIFT;
+const uint16_t PAGE_MASK = PAGE_SIZE - 1;
+const int PAGE_COUNT = (ADDRESS_MASK + 1) >> PAGE_SHIFT;
+
+// Handlers receive the 13-bit bus address.
+using ReadHandler = uint8_t (*)(uint16_t address);
+using WriteHandler = void (*)(uint16_t address, uint8_t value);
+
+struct BusPage
+{
+  // Host memory backing the page, or nullptr to call the handler instead.
+  uint8_t *read;
+  uint8_t *write;
+  ReadHandler readHandler;
+  WriteHandler writeHandler;
+};
+
+extern BusPage busPages[PAGE_COUNT];
+
+/**
+ * Map [start, start + size) directly onto host memory, or onto a handler. `start` and
+ * `size` must be multiples of PAGE_SIZE. Mapping memory replaces the page's handler for
+ * that direction and vice versa, so remapping (e.g. for a bank switch) is a pointer update.
+ */
+void busMapRead(uint16_t start, uint16_t size, uint8_t *memory);
+void busMapWrite(uint16_t start, uint16_t size, uint8_t *memory);
+void busMapReadHandler(uint16_t start, uint16_t size, ReadHandler handler);
+void busMapWriteHandler(uint16_t start, uint16_t size, WriteHandler handler);
+
+// Accesses to nothing: reads return 0 and writes are ignored.
+uint8_t openBusRead(uint16_t address);
+void openBusWrite(uint16_t address, uint8_t value);
+
+inline uint8_t busRead(uint16_t address)
+{
+  address &= ADDRESS_MASK;
+  const BusPage &page = busPages[address >> PAGE_SHIFT];
+  if (page.read)
+    return page.read[address & PAGE_MASK];
+  return page.readHandler(address);
+}
+
+inline void busWrite(uint16_t address, uint8_t value)
+{
+  address &= ADDRESS_MASK;
+  const BusPage &page = busPages[address >> PAGE_SHIFT];
+  if (page.write)
+    page.write[address & PAGE_MASK] = value;
+  else
+    page.writeHandler(address, value);
+}
@@ -0,0 +1,372 @@
+#include <cstdio>
+#include <cstring>
+
+#include "bus.h"
+#include "cart.h"
+
+Cartridge cart;
+static uint8_t rom[MAX_ROM_SIZE];
+
+// Hotspots of the F-type schemes and E0 all sit in the last page of the ROM window,
+// so only that page needs a handler; every other ROM page is read directly.
+const uint16_t HOTSPOT_PAGE = 0x1FC0;
+// The FE scheme watches the stack page, where JSR and RTS touch $01FE.
+const uint16_t FE_STACK_PAGE = 0x01C0;
+
+// First ROM byte shown by each slot.
+static uint8_t *slotData[4];
+// Bus pages that FE and 3F snoop, as mapped before the cartridge took them over.
+static BusPage chainedPage;
+
+// ----- Detection -----
+
+// 32-bit FNV-1a.
+static uint32_t hashRom(const uint8_t *data, int size)
+{
+  uint32_t hash = 2166136261u;
+  for (int i = 0; i < size; i++)
+    hash = (hash ^ data[i]) * 16777619u;
+  return hash;
+}
+
+static bool containsSignature(const uint8_t *data, int size, const uint8_t *signature, int length)
+{
+  for (int i = 0; i + length <= size; i++)
+    if (memcmp(data + i, signature, length) == 0)
+      return true;
+  return false;
+}
+
+// E0 games switch slices with stores or loads at $1FE0-$1FF7.
+static bool isProbablyE0(const uint8_t *data, int size)
+{
+  static const uint8_t SIGNATURES[][3] = {
+      {0x8D, 0xE0, 0x1F}, // STA $1FE0
+      {0x8D, 0xE0, 0x5F}, // STA $5FE0
+      {0x8D, 0xE9, 0xFF}, // STA $FFE9
+      {0x0C, 0xE0, 0x1F}, // NOP $1FE0
+      {0xAD, 0xE0, 0x1F}, // LDA $1FE0
+      {0xAD, 0xE9, 0xFF}, // LDA $FFE9
+      {0xAD, 0xED, 0xFF}, // LDA $FFED
+      {0xAD, 0xF3, 0xBF}, // LDA $BFF3
+  };
+  for (const auto &signature : SIGNATURES)
+    if (containsSignature(data, size, signature, 3))
+      return true;
+  return false;
+}
+
+// Code sequences found around the bank-switching subroutine calls of Activision's FE games.
+static bool isProbablyFE(const uint8_t *data, int size)
+{
+  static const uint8_t SIGNATURES[][5] = {
+      {0x20, 0x00, 0xD0, 0xC6, 0xC5}, // JSR $D000; DEC $C5
+      {0x20, 0xC3, 0xF8, 0xA5, 0x82}, // JSR $F8C3; LDA $82
+      {0xD0, 0xFB, 0x20, 0x73, 0xFE}, // BNE $FB; JSR $FE73
+      {0x20, 0x00, 0xF0, 0x84, 0xD6}, // JSR $F000; STY $D6
+  };
+  for (const auto &signature : SIGNATURES)
+    if (containsSignature(data, size, signature, 5))
+      return true;
+  return false;
+}
+
+// 3F games switch with STA $3F, usually in several places.
+static bool isProbably3F(const uint8_t *data, int size)
+{
+  static const uint8_t SIGNATURE[] = {0x85, 0x3F}; // STA $3F
+  int count = 0;
+  for (int i = 0; i + 2 <= size && count < 2; i++)
+    if (memcmp(data + i, SIGNATURE, 2) == 0)
+      count++;
+  return count >= 2;
+}
+
+// A Superchip ROM has its RAM write port ($1000-$107F) unused in every bank, so those
+// bytes are filled with a single value.
+static bool isProbablySuperchip(const uint8_t *data, int size)
+{
+  for (int bank = 0; bank < size; bank += 4096)
+    for (int i = 1; i < 128; i++)
+      if (data[bank + i] != data[bank])
+        return false;
+  return true;
+}
+
+static CartType detectType(const uint8_t *data, int size)
+{
+  if (size <= 4096)
+    return CartType::Standard;
+  if (size == 8192)
+  {
+    if (isProbablyE0(data, size))
+      return CartType::E0;
+    if (isProbably3F(data, size))
+      return CartType::Tiger3F;
+    if (isProbablyFE(data, size))
+      return CartType::FE;
+    return CartType::F8;
+  }
+  if (size == 12288)
+    return CartType::FA;
+  if (isProbably3F(data, size))
+    return CartType::Tiger3F;
+  if (size == 16384)
+    return CartType::F6;
+  if (size == 32768)
+    return CartType::F4;
+  // Other sizes are most likely 3F images without the usual stores.
+  return CartType::Tiger3F;
+}
+
+// ----- Mapping -----
+
+// Point the bus pages of one slot at its bank. Pages that belong to the extra RAM or
+// carry hotspots keep their handlers.
+static void mapSlot(int slot)
+{
+  slotData[slot] = rom + cart.slotBank[slot] * cart.sliceSize;
+  uint16_t start = 0x1000 + slot * cart.sliceSize;
+  uint16_t ramEnd = 0x1000 + 2 * cart.ramSize;
+  bool hotspots = cart.type != CartType::Standard && cart.type != CartType::FE && cart.type != CartType::Tiger3F;
+  for (int offset = 0; offset < cart.sliceSize; offset += PAGE_SIZE)
+  {
+    uint16_t address = start + offset;
+    if (address < ramEnd || (hotspots && address == HOTSPOT_PAGE))
+      continue;
+    busMapRead(address, PAGE_SIZE, slotData[slot] + offset);
+  }
+}
+
+static void selectBank(int slot, int bank)
+{
+  bank %= cart.bankCount;
+  if (cart.slotBank[slot] == bank)
+    return;
+  cart.slotBank[slot] = bank;
+  mapSlot(slot);
+}
+
+// Read through the slots, for pages served by a handler.
+static uint8_t readSlots(uint16_t address)
+{
+  uint16_t offset = address & 0x0FFF;
+  return slotData[offset / cart.sliceSize][offset % cart.sliceSize];
+}
+
+// Switch banks if `address` is a hotspot. Both reads and writes trigger a switch.
+static void checkHotspot(uint16_t address)
+{
+  uint16_t offset = address & 0x0FFF;
+  switch (cart.type)
+  {
+  case CartType::F8:
+    if (offset >= 0xFF8 && offset <= 0xFF9)
+      selectBank(0, offset - 0xFF8);
+    break;
+  case CartType::F6:
+    if (offset >= 0xFF6 && offset <= 0xFF9)
+      selectBank(0, offset - 0xFF6);
+    break;
+  case CartType::F4:
+    if (offset >= 0xFF4 && offset <= 0xFFB)
+      selectBank(0, offset - 0xFF4);
+    break;
+  case CartType::FA:
+    if (offset >= 0xFF8 && offset <= 0xFFA)
+      selectBank(0, offset - 0xFF8);
+    break;
+  case CartType::E0:
+    // $1FE0-$1FE7 select the bank of slice 0, $1FE8-$1FEF slice 1 and $1FF0-$1FF7 slice 2.
+    if (offset >= 0xFE0 && offset <= 0xFF7)
+      selectBank((offset - 0xFE0) >> 3, offset & 7);
+    break;
+  default:
+    break;
+  }
+}
+
+static uint8_t hotspotRead(uint16_t address)
+{
+  checkHotspot(address);
+  return readSlots(address);
+}
+
+static void hotspotWrite(uint16_t address, uint8_t value)
+{
+  (void)value;
+  checkHotspot(address);
+}
+
+// FE: after an access to $01FE, the next byte on the data bus is the high byte of the
+// address JSR or RTS is going to. D5 set selects bank 0 ($Fxxx), clear selects bank 1
+// ($Dxxx).
+static void feSelect(uint8_t value)
+{
+  cart.fePending = false;
+  cart.slotBank[0] = (value & 0x20) ? 0 : 1;
+  mapSlot(0);
+}
+
+// While an FE switch is pending, ROM reads go through here to see the deciding byte.
+static uint8_t feSnoopRead(uint16_t address)
+{
+  uint8_t value = readSlots(address);
+  feSelect(value);
+  return value;
+}
+
+static void feArm()
+{
+  cart.fePending = true;
+  busMapReadHandler(0x1000, 0x1000, feSnoopRead);
+}
+
+static uint8_t feStackRead(uint16_t address)
+{
+  uint8_t value = chainedPage.read ? chainedPage.read[address & PAGE_MASK] : chainedPage.readHandler(address);
+  if (cart.fePending)
+    feSelect(value);
+  else if (address == 0x01FE)
+    feArm();
+  return value;
+}
+
+static void feStackWrite(uint16_t address, uint8_t value)
+{
+  if (chainedPage.write)
+    chainedPage.write[address & PAGE_MASK] = value;
+  else
+    chainedPage.writeHandler(address, value);
+  if (cart.fePending)
+    feSelect(value);
+  else if (address == 0x01FE)
+    feArm();
+}
+
+// 3F: a write to $00-$3F selects the bank of the lower 2K slice, and also reaches the TIA.
+static void tiger3FWrite(uint16_t address, uint8_t value)
+{
+  selectBank(0, value);
+  chainedPage.writeHandler(address, value);
+}
+
+void cartLoad(const uint8_t *data, int size)
+{
+  if (size > MAX_ROM_SIZE)
+  {
+    printf("Warning: ROM size (%d bytes) exceeds %d bytes. Only the first %d bytes will be used.\n",
+           size, MAX_ROM_SIZE, MAX_ROM_SIZE);
+    size = MAX_ROM_SIZE;
+  }
+  memset(rom, 0, sizeof(rom));
+  if (size > 0)
+    memcpy(rom, data, size);
+
+  memset(&cart, 0, sizeof(cart));
+  cart.type = detectType(rom, size);
+  cart.size = size;
+  cart.romHash = hashRom(rom, size);
+  switch (cart.type)
+  {
+  case CartType::Standard:
+    // A 2K cartridge does not decode A11, so it shows up twice in the window.
+    cart.sliceSize = size <= 2048 ? 2048 : 4096;
+    break;
+  case CartType::E0:
+    cart.sliceSize = 1024;
+    break;
+  case CartType::Tiger3F:
+    cart.sliceSize = 2048;
+    break;
+  default:
+    cart.sliceSize = 4096;
+    break;
+  }
+  cart.bankCount = (size + cart.sliceSize - 1) / cart.sliceSize;
+  if (cart.bankCount == 0)
+    cart.bankCount = 1;
+
+  // Start in the last bank, which is where the F-type schemes keep their startup code.
+  // Fixed slices (the last of E0 and 3F) always show the last bank.
+  int slots = 4096 / cart.sliceSize;
+  for (int slot = 0; slot < slots; slot++)
+    cart.slotBank[slot] = cart.bankCount - 1;
+  if (cart.type == CartType::E0)
+  {
+    cart.slotBank[0] = 4;
+    cart.slotBank[1] = 5;
+    cart.slotBank[2] = 6;
+  }
+  else if (cart.type == CartType::FE)
+    cart.slotBank[0] = 0;
+  else if (cart.type == CartType::Standard)
+    cart.slotBank[0] = cart.slotBank[1] = 0;
+
+  if (cart.type == CartType::FA)
+    cart.ramSize = 256;
+  else if ((cart.type == CartType::F8 || cart.type == CartType::F6 || cart.type == CartType::F4) &&
+           isProbablySuperchip(rom, size))
+    cart.ramSize = 128;
+}
+
+void cartMap()
+{
+  // The cartridge port has no write line, so writes to ROM go nowhere.
+  busMapWriteHandler(0x1000, 0x1000, openBusWrite);
+
+  if (cart.ramSize)
+  {
+    // Reading the write port does not return RAM contents.
+    busMapReadHandler(0x1000, cart.ramSize, openBusRead);
+    busMapWrite(0x1000, cart.ramSize, cart.ram);
+    busMapRead(0x1000 + cart.ramSize, cart.ramSize, cart.ram);
+  }
+
+  switch (cart.type)
+  {
+  case CartType::F8:
+  case CartType::F6:
+  case CartType::F4:
+  case CartType::FA:
+  case CartType::E0:
+    busMapReadHandler(HOTSPOT_PAGE, PAGE_SIZE, hotspotRead);
+    busMapWriteHandler(HOTSPOT_PAGE, PAGE_SIZE, hotspotWrite);
+    break;
+  case CartType::FE:
+    chainedPage = busPages[FE_STACK_PAGE >> PAGE_SHIFT];
+    busMapReadHandler(FE_STACK_PAGE, PAGE_SIZE, feStackRead);
+    busMapWriteHandler(FE_STACK_PAGE, PAGE_SIZE, feStackWrite);
+    break;
+  case CartType::Tiger3F:
+    chainedPage = busPages[0];
+    busMapWriteHandler(0x0000, PAGE_SIZE, tiger3FWrite);
+    break;
+  default:
+    break;
+  }
+
+  cartSync();
+}
+
+void cartSync()
+{
+  int slots = 4096 / cart.sliceSize;
+  for (int slot = 0; slot < slots; slot++)
+    mapSlot(slot);
+  if (cart.fePending)
+    feArm();
+}
+
+uint8_t cartPeek(uint16_t address)
+{
+  return readSlots(address);
+}
+
+int cartRomOffset(uint16_t address)
+{
+  uint16_t offset = address & 0x0FFF;
+  if (!(address & 0x1000) || offset < 2 * cart.ramSize)
+    return -1;
+  return cart.slotBank[offset / cart.sliceSize] * cart.sliceSize + offset % cart.sliceSize;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+
+// Largest ROM accepted (32 banks of 2K for 3F, or two full F4 images).
+const int MAX_ROM_SIZE = 64 * 1024;
+
+// Bank-switching schemes, named after their hotspot addresses as is customary.
+enum class CartType : uint8_t
+{
+  Standard, // 2K or 4K, no switching
+  F8,       // 8K: two 4K banks, hotspots $1FF8-$1FF9
+  F6,       // 16K: four 4K banks, hotspots $1FF6-$1FF9
+  F4,       // 32K: eight 4K banks, hotspots $1FF4-$1FFB
+  FA,       // 12K CBS RAM Plus: three 4K banks, hotspots $1FF8-$1FFA, 256 bytes of RAM
+  FE,       // 8K Activision: bank chosen by the data following an access to $01FE
+  E0,       // 8K Parker Brothers: four 1K slices, the last fixed, hotspots $1FE0-$1FF7
+  Tiger3F,  // Tigervision 3F: 2K banks, lower slice selected by writes to $00-$3F
+};
+
+/**
+ * Cartridge mapping state. The ROM window ($1000-$1FFF) is split into slots of
+ * `sliceSize` bytes, each showing one bank of the ROM. Switching a bank only repoints
+ * the bus pages of that slot; no memory is copied.
+ */
+struct Cartridge
+{
+  CartType type;
+  int size;          // ROM size in bytes
+  uint32_t romHash;  // FNV-1a hash of the ROM, which identifies it in snapshots
+  int sliceSize;     // Bytes per slot: 4096, 2048 or 1024
+  int bankCount;     // Number of banks of sliceSize bytes
+  uint8_t slotBank[4];
+  // Extra RAM (Superchip: 128 bytes, FA: 256). It is written through $1000 + n and read
+  // through $1000 + ramSize + n.
+  int ramSize;
+  uint8_t ram[256];
+  bool fePending; // FE: $01FE was accessed, the next access selects the bank
+};
+
+extern Cartridge cart;
+
+/**
+ * Copy a ROM image into the cartridge and detect its bank-switching scheme from its size
+ * and contents. The caller maps the bus afterwards.
+ */
+void cartLoad(const uint8_t *data, int size);
+
+// Map the cartridge into the bus, including its hotspot handlers. Call after the TIA and
+// RIOT have been mapped, since some schemes snoop their pages.
+void cartMap();
+
+// Repoint the bus at the banks in `cart` after it has been restored from a snapshot.
+void cartSync();
+
+// Read the ROM window ($1000-$1FFF) as currently banked, without triggering hotspots.
+uint8_t cartPeek(uint16_t address);
+
+// Offset in the ROM image of the byte the ROM window shows at `address` in the current
+// banking, or -1 if `address` is outside the window or on the extra RAM.
+int cartRomOffset(uint16_t address);
@@ -0,0 +1,545 @@
+#include <array>
+#include <cstddef>
+#include <utility>
+
+#include "cpu6502.h"
+#include "opcodes.h"
+
+Cpu cpu;
+
+// ----- Helpers -----
+
+// Set the Zero and Negative flags from a result. They are only recorded here; see
+// cpuStatus().
+static inline void setNZ(uint8_t value)
+{
+  cpu.zResult = value;
+  cpu.nResult = value;
+}
+
+static inline void setFlag(uint8_t flag, bool on)
+{
+  cpu.status = on ? (cpu.status | flag) : (cpu.status & ~flag);
+}
+
+// Read the byte at pc and advance past it.
+static inline uint8_t fetch()
+{
+  return busRead(cpu.pc++);
+}
+
+static inline uint16_t fetch16()
+{
+  uint8_t lo = fetch();
+  return lo | (fetch() << 8);
+}
+
+static inline void push(uint8_t value)
+{
+  busWrite(0x100 | cpu.SP--, value);
+}
+
+static inline uint8_t pull()
+{
+  return busRead(0x100 | ++cpu.SP);
+}
+
+// Add one cycle if indexing from base to address crossed a page boundary.
+static inline void pageCrossPenalty(uint16_t base, uint16_t address)
+{
+  cpu.cycles += ((base ^ address) & 0xFF00) != 0;
+}
+
+/**
+ * Compute the effective address for a memory addressing mode, consuming its operand bytes.
+ * Zero-page indexing and pointers wrap within page zero, and JMP ($xxFF) fetches its high
+ * byte from $xx00, as on the real chip.
+ *
+ * @tparam PENALTY Whether crossing a page while indexing costs an extra cycle.
+ */
+template <Mode M, bool PENALTY>
+static inline uint16_t effectiveAddress()
+{
+  if constexpr (M == Mode::ZeroPage)
+    return fetch();
+  else if constexpr (M == Mode::ZeroPageX)
+    return (fetch() + cpu.X) & 0xFF;
+  else if constexpr (M == Mode::ZeroPageY)
+    return (fetch() + cpu.Y) & 0xFF;
+  else if constexpr (M == Mode::Absolute)
+    return fetch16();
+  else if constexpr (M == Mode::AbsoluteX || M == Mode::AbsoluteY)
+  {
+    uint16_t base = fetch16();
+    uint16_t address = base + (M == Mode::AbsoluteX ? cpu.X : cpu.Y);
+    if constexpr (PENALTY)
+      pageCrossPenalty(base, address);
+    return address;
+  }
+  else if constexpr (M == Mode::Indirect)
+  {
+    uint16_t pointer = fetch16();
+    uint8_t lo = busRead(pointer);
+    uint8_t hi = busRead((pointer & 0xFF00) | ((pointer + 1) & 0x00FF));
+    return lo | (hi << 8);
+  }
+  else if constexpr (M == Mode::IndirectX)
+  {
+    uint8_t pointer = fetch() + cpu.X;
+    return busRead(pointer) | (busRead((pointer + 1) & 0xFF) << 8);
+  }
+  else if constexpr (M == Mode::IndirectY)
+  {
+    uint8_t pointer = fetch();
+    uint16_t base = busRead(pointer) | (busRead((pointer + 1) & 0xFF) << 8);
+    uint16_t address = base + cpu.Y;
+    if constexpr (PENALTY)
+      pageCrossPenalty(base, address);
+    return address;
+  }
+  else
+  {
+    static_assert(M == Mode::ZeroPage, "addressing mode has no effective address");
+    return 0;
+  }
+}
+
+// Add with carry (binary mode).
+static inline void addWithCarry(uint8_t value)
+{
+  uint16_t sum = cpu.A + value + (cpu.status & FLAG_C);
+  setFlag(FLAG_V, (~(cpu.A ^ value) & (cpu.A ^ sum) & 0x80) != 0);
+  setFlag(FLAG_C, sum > 0xFF);
+  cpu.A = sum & 0xFF;
+  setNZ(cpu.A);
+}
+
+// ----- Decimal Mode -----
+// With D set, ADC and SBC treat their operands as two BCD digits. The low digit's
+// adjustment (and the carry or borrow into the high digit) is looked up by carry and the
+// two low nibbles; the high digit is then adjusted arithmetically. The flags follow the
+// NMOS 6502: Z always comes from the binary result, N and V of ADC from the sum before
+// the high digit is adjusted, and all flags of SBC from the binary subtraction.
+
+struct DecimalTables
+{
+  // Adjusted low digit plus $10 if it carries, by [carry][A & $0F][operand & $0F].
+  uint8_t addLow[2][16][16];
+  // Adjusted low digit minus $10 if it borrows, by [carry][A & $0F][operand & $0F].
+  int8_t subtractLow[2][16][16];
+};
+
+static constexpr DecimalTables makeDecimalTables()
+{
+  DecimalTables tables = {};
+  for (int carry = 0; carry < 2; carry++)
+  {
+    for (int a = 0; a < 16; a++)
+    {
+      for (int b = 0; b < 16; b++)
+      {
+        int sum = a + b + carry;
+        tables.addLow[carry][a][b] = sum >= 0x0A ? ((sum + 0x06) & 0x0F) + 0x10 : sum;
+        int difference = a - b + carry - 1;
+        tables.subtractLow[carry][a][b] = difference < 0 ? ((difference - 0x06) & 0x0F) - 0x10 : difference;
+      }
+    }
+  }
+  return tables;
+}
+
+static constexpr DecimalTables DECIMAL = makeDecimalTables();
+
+static inline void addDecimal(uint8_t value)
+{
+  int carry = cpu.status & FLAG_C;
+  int low = DECIMAL.addLow[carry][cpu.A & 0x0F][value & 0x0F];
+  int sum = (cpu.A & 0xF0) + (value & 0xF0) + low;
+  int signedSum = static_cast<int8_t>(cpu.A & 0xF0) + static_cast<int8_t>(value & 0xF0) + low;
+  cpu.zResult = cpu.A + value + carry;
+  cpu.nResult = sum;
+  setFlag(FLAG_V, signedSum < -128 || signedSum > 127);
+  if (sum >= 0xA0)
+    sum += 0x60;
+  setFlag(FLAG_C, sum > 0xFF);
+  cpu.A = sum & 0xFF;
+}
+
+static inline void subtractDecimal(uint8_t value)
+{
+  uint8_t a = cpu.A;
+  int low = DECIMAL.subtractLow[cpu.status & FLAG_C][a & 0x0F][value & 0x0F];
+  addWithCarry(value ^ 0xFF);
+  int difference = (a & 0xF0) - (value & 0xF0) + low;
+  if (difference < 0)
+    difference -= 0x60;
+  cpu.A = difference & 0xFF;
+}
+
+static inline void compare(uint8_t reg, uint8_t value)
+{
+  setFlag(FLAG_C, reg >= value);
+  setNZ(reg - value);
+}
+
+// ARR: AND, then rotate right, with flags (and in decimal mode a BCD fix-up) from the
+// adder that the NMOS 6502 runs alongside.
+static inline void andRotateRight(uint8_t value)
+{
+  uint8_t anded = cpu.A & value;
+  uint8_t carry = cpu.status & FLAG_C;
+  cpu.A = (anded >> 1) | (carry << 7);
+  if (!(cpu.status & FLAG_D))
+  {
+    setNZ(cpu.A);
+    setFlag(FLAG_C, cpu.A & 0x40);
+    setFlag(FLAG_V, ((cpu.A >> 6) ^ (cpu.A >> 5)) & 0x01);
+    return;
+  }
+
+  cpu.zResult = cpu.A;
+  cpu.nResult = carry << 7;
+  setFlag(FLAG_V, (anded ^ cpu.A) & 0x40);
+  if ((anded & 0x0F) + (anded & 0x01) > 0x05)
+    cpu.A = (cpu.A & 0xF0) | ((cpu.A + 0x06) & 0x0F);
+  bool highCarry = (anded & 0xF0) + (anded & 0x10) > 0x50;
+  if (highCarry)
+    cpu.A += 0x60;
+  setFlag(FLAG_C, highCarry);
+}
+
+// ----- Operations -----
+
+// Operations that consume a value read from memory (or an immediate operand).
+template <Op OP>
+static inline void readOp(uint8_t value)
+{
+  if constexpr (OP == Op::LDA)
+    setNZ(cpu.A = value);
+  else if constexpr (OP == Op::LDX)
+    setNZ(cpu.X = value);
+  else if constexpr (OP == Op::LDY)
+    setNZ(cpu.Y = value);
+  else if constexpr (OP == Op::AND)
+    setNZ(cpu.A &= value);
+  else if constexpr (OP == Op::ORA)
+    setNZ(cpu.A |= value);
+  else if constexpr (OP == Op::EOR)
+    setNZ(cpu.A ^= value);
+  else if constexpr (OP == Op::ADC)
+  {
+    if (cpu.status & FLAG_D)
+      addDecimal(value);
+    else
+      addWithCarry(value);
+  }
+  else if constexpr (OP == Op::SBC)
+  {
+    if (cpu.status & FLAG_D)
+      subtractDecimal(value);
+    else
+      addWithCarry(value ^ 0xFF); // Binary subtraction is addition of the one's complement.
+  }
+  else if constexpr (OP == Op::CMP)
+    compare(cpu.A, value);
+  else if constexpr (OP == Op::CPX)
+    compare(cpu.X, value);
+  else if constexpr (OP == Op::CPY)
+    compare(cpu.Y, value);
+  else if constexpr (OP == Op::BIT)
+  {
+    cpu.zResult = cpu.A & value;
+    cpu.nResult = value;
+    setFlag(FLAG_V, value & FLAG_V);
+  }
+  else if constexpr (OP == Op::LAX)
+    setNZ(cpu.A = cpu.X = value);
+  else if constexpr (OP == Op::LAS)
+    setNZ(cpu.A = cpu.X = cpu.SP = cpu.SP & value);
+  else if constexpr (OP == Op::ANC)
+  {
+    setNZ(cpu.A &= value);
+    setFlag(FLAG_C, cpu.A & 0x80);
+  }
+  else if constexpr (OP == Op::ALR)
+  {
+    cpu.A &= value;
+    setFlag(FLAG_C, cpu.A & 0x01);
+    setNZ(cpu.A >>= 1);
+  }
+  else if constexpr (OP == Op::ARR)
+    andRotateRight(value);
+  else if constexpr (OP == Op::SBX)
+  {
+    uint8_t anded = cpu.A & cpu.X;
+    setFlag(FLAG_C, anded >= value);
+    setNZ(cpu.X = anded - value);
+  }
+  // ANE and LXA mix A with a value that depends on the chip; $EE is the common one.
+  else if constexpr (OP == Op::ANE)
+    setNZ(cpu.A = (cpu.A | 0xEE) & cpu.X & value);
+  else if constexpr (OP == Op::LXA)
+    setNZ(cpu.A = cpu.X = (cpu.A | 0xEE) & value);
+  else if constexpr (OP == Op::NOP)
+    (void)value;
+  else
+    static_assert(OP == Op::NOP, "not a read operation");
+}
+
+// Shifts, rotates, increments and decrements: return the modified value.
+template <Op OP>
+static inline uint8_t modifyOp(uint8_t value)
+{
+  uint8_t result;
+  if constexpr (modifyPart(OP) != OP)
+  {
+    result = modifyOp<modifyPart(OP)>(value);
+    readOp<readPart(OP)>(result);
+    return result;
+  }
+  else if constexpr (OP == Op::ASL)
+  {
+    setFlag(FLAG_C, value & 0x80);
+    result = value << 1;
+  }
+  else if constexpr (OP == Op::LSR)
+  {
+    setFlag(FLAG_C, value & 0x01);
+    result = value >> 1;
+  }
+  else if constexpr (OP == Op::ROL)
+  {
+    result = (value << 1) | (cpu.status & FLAG_C);
+    setFlag(FLAG_C, value & 0x80);
+  }
+  else if constexpr (OP == Op::ROR)
+  {
+    result = (value >> 1) | ((cpu.status & FLAG_C) << 7);
+    setFlag(FLAG_C, value & 0x01);
+  }
+  else if constexpr (OP == Op::INC)
+    result = value + 1;
+  else if constexpr (OP == Op::DEC)
+    result = value - 1;
+  else
+    static_assert(OP == Op::INC, "not a read-modify-write operation");
+  setNZ(result);
+  return result;
+}
+
+template <Op OP>
+static inline uint8_t storeValue()
+{
+  if constexpr (OP == Op::STA)
+    return cpu.A;
+  else if constexpr (OP == Op::STX)
+    return cpu.X;
+  else if constexpr (OP == Op::SAX)
+    return cpu.A & cpu.X;
+  else
+    return cpu.Y;
+}
+
+/**
+ * SHA, SHX, SHY and TAS store a register ANDed with the high byte of the base address
+ * plus one. When indexing crosses a page, the stored value also replaces the high byte of
+ * the target address. TAS first sets SP to A & X.
+ */
+template <Op OP, Mode M>
+static inline void storeHighByte()
+{
+  uint16_t base;
+  if constexpr (M == Mode::IndirectY)
+  {
+    uint8_t pointer = fetch();
+    base = busRead(pointer) | (busRead((pointer + 1) & 0xFF) << 8);
+  }
+  else
+    base = fetch16();
+  uint16_t address = base + (M == Mode::AbsoluteX ? cpu.X : cpu.Y);
+
+  uint8_t reg;
+  if constexpr (OP == Op::SHX)
+    reg = cpu.X;
+  else if constexpr (OP == Op::SHY)
+    reg = cpu.Y;
+  else
+    reg = cpu.A & cpu.X;
+  if constexpr (OP == Op::TAS)
+    cpu.SP = reg;
+
+  uint8_t value = reg & ((base >> 8) + 1);
+  if ((base ^ address) & 0xFF00)
+    address = (address & 0x00FF) | (value << 8);
+  busWrite(address, value);
+}
+
+template <Op OP>
+static inline bool branchTaken()
+{
+  if constexpr (OP == Op::BPL)
+    return !(cpu.nResult & FLAG_N);
+  else if constexpr (OP == Op::BMI)
+    return cpu.nResult & FLAG_N;
+  else if constexpr (OP == Op::BVC)
+    return !(cpu.status & FLAG_V);
+  else if constexpr (OP == Op::BVS)
+    return cpu.status & FLAG_V;
+  else if constexpr (OP == Op::BCC)
+    return !(cpu.status & FLAG_C);
+  else if constexpr (OP == Op::BCS)
+    return cpu.status & FLAG_C;
+  else if constexpr (OP == Op::BNE)
+    return cpu.zResult != 0;
+  else
+    return cpu.zResult == 0; // BEQ
+}
+
+// Operations with no memory operand.
+template <Op OP>
+static inline void impliedOp()
+{
+  switch (OP)
+  {
+  case Op::CLC: cpu.status &= ~FLAG_C; break;
+  case Op::SEC: cpu.status |= FLAG_C; break;
+  case Op::CLI: cpu.status &= ~FLAG_I; break;
+  case Op::SEI: cpu.status |= FLAG_I; break;
+  case Op::CLD: cpu.status &= ~FLAG_D; break;
+  case Op::SED: cpu.status |= FLAG_D; break;
+  case Op::CLV: cpu.status &= ~FLAG_V; break;
+  case Op::TAX: setNZ(cpu.X = cpu.A); break;
+  case Op::TAY: setNZ(cpu.Y = cpu.A); break;
+  case Op::TXA: setNZ(cpu.A = cpu.X); break;
+  case Op::TYA: setNZ(cpu.A = cpu.Y); break;
+  case Op::TSX: setNZ(cpu.X = cpu.SP); break;
+  case Op::TXS: cpu.SP = cpu.X; break;
+  case Op::INX: setNZ(++cpu.X); break;
+  case Op::INY: setNZ(++cpu.Y); break;
+  case Op::DEX: setNZ(--cpu.X); break;
+  case Op::DEY: setNZ(--cpu.Y); break;
+  case Op::PHA: push(cpu.A); break;
+  case Op::PHP: push(cpuStatus() | FLAG_B | FLAG_U); break;
+  case Op::PLA: setNZ(cpu.A = pull()); break;
+  case Op::PLP: cpuSetStatus((pull() & ~FLAG_B) | FLAG_U); break;
+  case Op::NOP: break;
+  case Op::BRK:
+  {
+    // BRK skips a padding byte, pushes the return address and status, and jumps through $FFFE.
+    cpu.pc++;
+    push(cpu.pc >> 8);
+    push(cpu.pc & 0xFF);
+    push(cpuStatus() | FLAG_B | FLAG_U);
+    cpu.status |= FLAG_I;
+    cpu.pc = busRead(0xFFFE) | (busRead(0xFFFF) << 8);
+    break;
+  }
+  case Op::RTI:
+  {
+    cpuSetStatus((pull() & ~FLAG_B) | FLAG_U);
+    uint8_t lo = pull();
+    cpu.pc = lo | (pull() << 8);
+    break;
+  }
+  case Op::RTS:
+  {
+    uint8_t lo = pull();
+    cpu.pc = (lo | (pull() << 8)) + 1;
+    break;
+  }
+  case Op::JAM:
+    // The CPU locks up until reset. Running the opcode again keeps time passing.
+    cpu.pc--;
+    break;
+  default:
+    break;
+  }
+}
+
+/**
+ * Execute one opcode. One instance of this template is generated per opcode, with the
+ * operation and addressing mode taken from OPCODES at compile time, so each handler
+ * contains only the code for its own instruction.
+ */
+template <uint8_t OPCODE>
+static void execute()
+{
+  constexpr Op op = OPCODES[OPCODE].op;
+  constexpr Mode mode = OPCODES[OPCODE].mode;
+  constexpr bool penalty = hasPageCrossPenalty(op);
+
+  cpu.cycles += OPCODES[OPCODE].cycles;
+
+  if constexpr (mode == Mode::Implied)
+    impliedOp<op>();
+  else if constexpr (mode == Mode::Accumulator)
+    cpu.A = modifyOp<op>(cpu.A);
+  else if constexpr (mode == Mode::Immediate)
+    readOp<op>(fetch());
+  else if constexpr (mode == Mode::Relative)
+  {
+    // A taken branch costs one extra cycle, and another if it lands in a different page.
+    int8_t offset = static_cast<int8_t>(fetch());
+    if (branchTaken<op>())
+    {
+      uint16_t target = cpu.pc + offset;
+      cpu.cycles++;
+      pageCrossPenalty(cpu.pc, target);
+      cpu.pc = target;
+    }
+  }
+  else if constexpr (op == Op::JMP)
+    cpu.pc = effectiveAddress<mode, penalty>();
+  else if constexpr (op == Op::JSR)
+  {
+    // JSR pushes the address of its own last byte, before reading that byte.
+    uint8_t lo = fetch();
+    push(cpu.pc >> 8);
+    push(cpu.pc & 0xFF);
+    cpu.pc = lo | (busRead(cpu.pc) << 8);
+  }
+  else if constexpr (isStore(op))
+    busWrite(effectiveAddress<mode, penalty>(), storeValue<op>());
+  else if constexpr (isHighByteStore(op))
+    storeHighByte<op, mode>();
+  else if constexpr (isReadModifyWrite(op))
+  {
+    // The 6502 writes the unmodified value back before writing the result.
+    uint16_t address = effectiveAddress<mode, penalty>();
+    uint8_t value = busRead(address);
+    busWrite(address, value);
+    busWrite(address, modifyOp<op>(value));
+  }
+  else
+    readOp<op>(busRead(effectiveAddress<mode, penalty>()));
+}
+
+using Handler = void (*)();
+
+template <size_t... OPCODE>
+static constexpr std::array<Handler, 256> makeHandlers(std::index_sequence<OPCODE...>)
+{
+  return {{&execute<OPCODE>...}};
+}
+
+static constexpr std::array<Handler, 256> HANDLERS = makeHandlers(std::make_index_sequence<256>{});
+
+void cpuReset()
+{
+  cpu.A = 0;
+  cpu.X = 0;
+  cpu.Y = 0;
+  cpu.SP = 0xFD;
+  cpuSetStatus(FLAG_I | FLAG_U);
+  cpu.cycles = 0;
+}
+
+template <typename TracePolicy>
+void cpuStep()
+{
+  uint8_t opcode = fetch();
+  TracePolicy::record(cpu.pc - 1, opcode);
+  HANDLERS[opcode]();
+}
+
+template void cpuStep<CpuTrace>();
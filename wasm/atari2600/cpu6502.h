@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+
+#include "bus.h"
+#include "trace.h"
+
+// ----- Processor Status Flags -----
+const uint8_t FLAG_C = 0x01; // Carry
+const uint8_t FLAG_Z = 0x02; // Zero
+const uint8_t FLAG_I = 0x04; // Interrupt disable
+const uint8_t FLAG_D = 0x08; // Decimal mode
+const uint8_t FLAG_B = 0x10; // Break (only exists in copies of the status pushed to the stack)
+const uint8_t FLAG_U = 0x20; // Unused, always reads as 1
+const uint8_t FLAG_V = 0x40; // Overflow
+const uint8_t FLAG_N = 0x80; // Negative
+
+/**
+ * Registers of the 6507, the 6502 variant used by the Atari 2600.
+ */
+struct Cpu
+{
+  uint16_t pc;
+  uint8_t A;
+  uint8_t X;
+  uint8_t Y;
+  uint8_t status; // NV-BDIZC, except N and Z (see cpuStatus())
+  uint8_t SP;     // Stack pointer into page 1
+
+  // N and Z are evaluated lazily. Nearly every instruction changes them, so instead of
+  // updating the status bits each time, the values they derive from are stored and the
+  // bits are only built when something reads them. Z is set when zResult is 0, and N is
+  // bit 7 of nResult. They differ only after BIT and decimal ADC.
+  uint8_t zResult;
+  uint8_t nResult;
+
+  // CPU cycles elapsed since power-on. Each instruction's cycles are added when it starts
+  // (page-crossing penalties as soon as they are known), so during an instruction this is
+  // the cycle on which it completes, which is when its final memory access happens.
+  uint64_t cycles;
+};
+
+extern Cpu cpu;
+
+// The processor status register with N and Z built from their lazy sources.
+inline uint8_t cpuStatus()
+{
+  return (cpu.status & ~(FLAG_N | FLAG_Z)) | (cpu.zResult == 0 ? FLAG_Z : 0) | (cpu.nResult & FLAG_N);
+}
+
+// Set the whole status register (PLP, RTI).
+inline void cpuSetStatus(uint8_t status)
+{
+  cpu.status = status;
+  cpu.zResult = (status & FLAG_Z) ? 0 : 1;
+  cpu.nResult = status & FLAG_N;
+}
+
+// Put the registers into their power-on state. The caller sets pc.
+// The CPU accesses memory through busRead() and busWrite() (bus.h).
+void cpuReset();
+
+// Fetch, decode and execute one instruction, advancing cpu.cycles by its cycle count.
+// TracePolicy::record() sees each instruction before it runs (see trace.h).
+template <typename TracePolicy>
+void cpuStep();
+
+// Hold the CPU (RDY low) until `cycle`. The halted cycles are skipped in a single step.
+inline void cpuHaltUntil(uint64_t cycle)
+{
+  if (cpu.cycles < cycle)
+    cpu.cycles = cycle;
+}
@@ -1,402 +1,437 @@
 #include <cstdlib>
 #include <ctime>
 #include <cstdint>
-#include <cstring>
 #include <cstdio>
 
-// Define a virtual screen size for output (for demo purposes).
-const int SCREEN_WIDTH = 160;
-const int SCREEN_HEIGHT = 192;
-
-// The screen buffer will hold one 8‑bit value per pixel (grayscale).
-uint8_t screen[SCREEN_WIDTH * SCREEN_HEIGHT];
-uint8_t rgbScreen[SCREEN_WIDTH * SCREEN_HEIGHT * 3];
-
-// Atari 2600 cartridges are typically 4K in size.
-uint8_t memory[4096];
-
-// For a simple demonstration, we simulate one TIA register: background color (COLUBK).
-// In a real Atari 2600, many registers control various parts of the TIA.
-// Here we assume that writes to address 0x09 update the background color.
-uint8_t COLUBK = 0;
-
-// Program counter (PC) for our simplified CPU.
-uint16_t pc = 0;
-
-// ----- CPU Registers (Simplified 6502) -----
-// Accumulator
-uint8_t A = 0;
-// X register
-uint8_t X = 0;
-// Y register
-uint8_t Y = 0;
-// Processor status flags:
-// Bit 0: Carry, Bit 1: Zero, Bit 2: Interrupt Disable,
-// Bit 3: Decimal, Bit 4: Break, Bit 5: Unused, Bit 6: Overflow, Bit 7: Negative.
-uint8_t status = 0;
-// Stack Pointer (8-bit, typically starts at 0xFF)
-uint8_t SP = 0xFF;
-
-// Global variable to control verbosity of opcode logging.
-bool verboseLogging = false;
-
-// Define a structure for an RGB color.
-struct RGB
+#include "audio.h"
+#include "cart.h"
+#include "cpu6502.h"
+#include "palette.h"
+#include "recompiler.h"
+#include "riot.h"
+#include "scheduler.h"
+#include "state.h"
+#include "tia.h"
+#include "trace.h"
+
+// Palette selected by the frontend (REGION_AUTO follows the frame length).
+Region selectedRegion = REGION_AUTO;
+
+// ----- Timing -----
+// The CPU runs at the NTSC colour clock divided by 3 (frame timing is in tia.h).
+const double CPU_CLOCK_HZ = 3579545.0 / 3.0;
+const double CYCLES_PER_MS = CPU_CLOCK_HZ / 1000.0;
+// Cap on the cycles run by one call, so a long stall (e.g. a background tab) does not
+// make the emulator try to catch up all at once.
+const int MAX_FRAMES_PER_RUN = 4;
+
+// Cycles owed to the CPU by elapsed host time. Instructions cannot be split, so the
+// last one of a run can overshoot; the overshoot is carried over as a negative balance.
+double cycleBudget = 0;
+
+// runFrame() gives up on a frame after this many cycles. The TIA ends a frame by itself
+// after MAX_SCANLINES_PER_FRAME lines, so this only matters if that ever fails.
+const uint64_t FRAME_WATCHDOG_CYCLES = (MAX_SCANLINES_PER_FRAME + 1) * CYCLES_PER_SCANLINE;
+
+// ----- Frame Status -----
+// What runFrame() and runAhead() report to the frontend, which reads it from the heap as
+// three 32-bit integers.
+struct FrameStatus
 {
-  uint8_t r, g, b;
+  int32_t scanlines;    // Length of the frame (0 if the watchdog stopped it)
+  int32_t frameChanged; // 1 if the screen changed, so it needs to be uploaded again
+  int32_t audioSamples; // Host samples written to the audio ring during the frame
 };
 
-// Define a palette of 16 colors (a common approximation for Atari 2600 colors).
-const int PALETTE_SIZE = 16;
-RGB palette[PALETTE_SIZE] = {
-    {0x00, 0x00, 0x00}, // 0: Black (#000000) – Maps 0x00 to 0x0F
-    {0x1D, 0x2B, 0x53}, // 1: Dark Blue (#1D2B53) – Maps 0x10 to 0x1F
-    {0x7E, 0x25, 0x53}, // 2: Dark Purple (#7E2553) – Maps 0x20 to 0x2F
-    {0x00, 0x87, 0x51}, // 3: Dark Green (#008751) – Maps 0x30 to 0x3F
-    {0xAB, 0x52, 0x36}, // 4: Brown (#AB5236) – Maps 0x40 to 0x4F
-    {0x5F, 0x57, 0x4F}, // 5: Dark Gray (#5F574F) – Maps 0x50 to 0x5F
-    {0xC2, 0xC3, 0xC7}, // 6: Light Gray (#C2C3C7) – Maps 0x60 to 0x6F
-    {0xFF, 0xF1, 0xE8}, // 7: White (#FFF1E8) – Maps 0x70 to 0x7F
-    {0xFF, 0x00, 0x00}, // 8: Red (#FF0000) – Maps 0x80 to 0x8F
-    {0xFF, 0xA3, 0x00}, // 9: Orange (#FFA300) – Maps 0x90 to 0x9F
-    {0xFF, 0xEC, 0x27}, // 10: Yellow (#FFEC27) – Maps 0xA0 to 0xAF
-    {0x00, 0xE4, 0x36}, // 11: Bright Green (#00E436) – Maps 0xB0 to 0xBF
-    {0x29, 0xAD, 0xFF}, // 12: Sky Blue (#29ADFF) – Maps 0xC0 to 0xCF
-    {0x83, 0x76, 0x9C}, // 13: Lavender (#83769C) – Maps 0xD0 to 0xDF
-    {0xFF, 0x77, 0xA8}, // 14: Pink (#FF77A8) – Maps 0xE0 to 0xEF
-    {0xFF, 0xCC, 0xAA}  // 15: Peach (#FFCCAA) – Maps 0xF0 to 0xFF
-};
+FrameStatus frameStatus;
+
+// ----- Run-ahead -----
+// The presented screen is not part of a snapshot, so a frame completed while running ahead
+// stays on screen after rolling back.
+SaveState runAheadSnapshot;
+
+// ----- Rewind -----
+// A snapshot is taken after every frame run by runFrame(), into a ring covering the last
+// REWIND_FRAMES frames. Rewinding restores an older one and runs its next frame again, so
+// the screen shows the frame rewound to.
+const int REWIND_FRAMES = 600; // 10 seconds at 60 Hz
 
-// ----- Helper Functions for 6502 Flags -----
-// Set or clear the Zero flag based on a value.
-void updateZeroFlag(uint8_t value)
+SaveState rewindBuffer[REWIND_FRAMES];
+int rewindHead = 0;  // Slot of the next snapshot
+int rewindCount = 0; // Snapshots held; the newest is the current state
+
+void rewindPush()
 {
-  if (value == 0)
-    status |= 0x02; // Set Zero flag (bit 1)
-  else
-    status &= ~0x02; // Clear Zero flag
+  stateSave(rewindBuffer[rewindHead]);
+  rewindHead = (rewindHead + 1) % REWIND_FRAMES;
+  if (rewindCount < REWIND_FRAMES)
+    rewindCount++;
 }
 
-// This function overlays a simple playfield pattern into the screen buffer.
-// It reads PF0 from 0x0D, PF1 from 0x0E, and PF2 from 0x0F, builds a 48-bit mirrored pattern,
-// then for each pixel of the screen (or for a defined vertical region) it overrides the background
-// if the corresponding playfield bit is 1.
-void overlayPlayfield()
+// Drop the newest snapshot and return the one before it.
+const SaveState &rewindPop()
 {
-  // Read the playfield registers.
-  uint8_t PF0 = memory[0x0D];
-  uint8_t PF1 = memory[0x0E];
-  uint8_t PF2 = memory[0x0F];
-
-  // Combine PF0, PF1, PF2 into a 24-bit left-half pattern.
-  // (Typically, PF0 is only 4 bits in a real TIA, but for simplicity we use full 8 bits here.)
-  uint32_t patternLeft = (PF0 << 16) | (PF1 << 8) | PF2; // 24-bit pattern
-
-  // Build a 48-bit pattern by mirroring the left half.
-  bool playfield[48];
-  for (int i = 0; i < 24; i++)
-  {
-    // Extract bit i from the left half (bit 23 is the most significant bit).
-    int bit = (patternLeft >> (23 - i)) & 1;
-    playfield[i] = (bit != 0);
-    playfield[47 - i] = playfield[i]; // mirror it.
-  }
+  rewindHead = (rewindHead + REWIND_FRAMES - 1) % REWIND_FRAMES;
+  rewindCount--;
+  return rewindBuffer[(rewindHead + REWIND_FRAMES - 1) % REWIND_FRAMES];
+}
+
+// Snapshot exchanged with the frontend by saveSnapshot() and loadSnapshot().
+SaveState exportedSnapshot;
+
+// ----- Input -----
+// Keys reported by the frontend through setKeyDown/setKeyUp.
+enum Key
+{
+  KEY_UP,
+  KEY_DOWN,
+  KEY_LEFT,
+  KEY_RIGHT,
+  KEY_FIRE,
+  KEY_SELECT,
+  KEY_RESET,
+  KEY_COUNT
+};
+
+// Pin driven low by each key: the port and the bit.
+struct KeyPin
+{
+  uint8_t *pins;
+  uint8_t mask;
+};
 
-  // Choose a playfield color (a palette index).
-  // For example, use 0x70 which might map to white (depending on your palette).
-  uint8_t playfieldColor = 0x70;
+const KeyPin KEY_PINS[KEY_COUNT] = {
+    {&joystickPins, 0x10}, // P0 up
+    {&joystickPins, 0x20}, // P0 down
+    {&joystickPins, 0x40}, // P0 left
+    {&joystickPins, 0x80}, // P0 right
+    {&firePins, 0x01},     // P0 fire
+    {&switchPins, 0x02},   // Game select
+    {&switchPins, 0x01},   // Game reset
+};
+
+// ----- Emulation Loop -----
 
-  // For simplicity, overlay the playfield on the entire screen.
-  // Map each x coordinate to a bit in the 48-bit playfield:
-  for (int y = 0; y < SCREEN_HEIGHT; y++)
+/**
+ * Run the CPU until `target` cycles. Instructions run in bursts up to the next event
+ * deadline, with no per-instruction checks for the peripherals; the events that are
+ * due are dispatched in order between bursts. Within a burst, translated blocks
+ * (recompiler.h) run in place of the interpreter where they fit.
+ *
+ * @param stopAtFrameEnd Also stop after the instruction that ends a frame.
+ * @return Whether the run stopped at the end of a frame.
+ */
+bool runUntil(uint64_t target, bool stopAtFrameEnd)
+{
+  schedule(EVENT_RUN_END, target);
+  for (;;)
   {
-    for (int x = 0; x < SCREEN_WIDTH; x++)
+    while (cpu.cycles < scheduler.nextCycle)
+    {
+      if (recompilerEnabled && recompilerRun())
+        continue;
+      cpuStep<CpuTrace>();
+    }
+
+    uint64_t cycle;
+    EventType event;
+    while ((event = popDueEvent(cpu.cycles, cycle)) != EVENT_COUNT)
     {
-      // Compute the playfield bit index for this x.
-      // We map x in [0, SCREEN_WIDTH) to an index in [0, 48).
-      int bitIndex = (x * 48) / SCREEN_WIDTH;
-      if (bitIndex < 0)
-        bitIndex = 0;
-      if (bitIndex >= 48)
-        bitIndex = 47;
-      // If the corresponding playfield bit is set, override the pixel.
-      if (playfield[bitIndex])
+      switch (event)
       {
-        screen[y * SCREEN_WIDTH + x] = playfieldColor;
+      case EVENT_RUN_END:
+        return false;
+      case EVENT_FRAME_END:
+        if (stopAtFrameEnd)
+        {
+          unschedule(EVENT_RUN_END);
+          return true;
+        }
+        break;
+      case EVENT_FRAME_TIMEOUT:
+        tiaFrameTimeout(cycle);
+        break;
+      case EVENT_TIMER_UNDERFLOW:
+        riotTimerUnderflow();
+        break;
+      default:
+        break;
       }
     }
   }
 }
 
+// Run one frame (see runFrame()) and fill in frameStatus.
+void emulateFrame()
+{
+  // A frame that ended at the end of an earlier run() has already been presented.
+  unschedule(EVENT_FRAME_END);
+  screenChanged = false;
+  uint64_t samples = audioSamplesWritten;
+
+  // A VSYNC on the frame's first line (as at power-on) ends an empty frame; keep going.
+  uint64_t deadline = cpu.cycles + FRAME_WATCHDOG_CYCLES;
+  bool ended;
+  do
+    ended = runUntil(deadline, true);
+  while (ended && tia.lastFrameScanlines == 0);
+  audioCatchUp(cpu.cycles);
+
+  frameStatus.scanlines = ended ? tia.lastFrameScanlines : 0;
+  frameStatus.frameChanged = screenChanged;
+  frameStatus.audioSamples = static_cast<int32_t>(audioSamplesWritten - samples);
+}
+
+// ----- Memory Map -----
+// Devices are selected by address lines A12, A9 and A7:
+//   A12 = 1                   cartridge ($1000-$1FFF)
+//   A12 = 0, A7 = 0           TIA ($00-$7F)
+//   A12 = 0, A7 = 1, A9 = 0   RIOT RAM ($80-$FF)
+//   A12 = 0, A7 = 1, A9 = 1   RIOT I/O and timer ($280-$2FF)
+// Every other address line is ignored, which produces the mirrors.
+
+void mapBus()
+{
+  for (uint16_t block = 0; block < 0x1000; block += 0x80)
+  {
+    if (!(block & 0x80))
+    {
+      busMapReadHandler(block, 0x80, tiaRead);
+      busMapWriteHandler(block, 0x80, tiaWrite);
+    }
+    else if (!(block & 0x200))
+    {
+      busMapRead(block, 0x80, riot.ram);
+      busMapWrite(block, 0x80, riot.ram);
+    }
+    else
+    {
+      busMapReadHandler(block, 0x80, riotRead);
+      busMapWriteHandler(block, 0x80, riotWrite);
+    }
+  }
+
+  cartMap();
+}
+
 extern "C"
 {
 
   /**
    * Initialize the Atari 2600 state.
    *
-   * Clears the screen, zeroes memory, and sets the initial program counter.
+   * Clears the screen, zeroes memory, maps the bus and sets the initial program counter.
    */
   void init()
   {
     std::srand(static_cast<unsigned int>(std::time(nullptr)));
-    memset(screen, 0, sizeof(screen));
-    memset(memory, 0, sizeof(memory));
-    pc = 0;
-    COLUBK = 0;
+    cpuReset();
+    cpu.pc = 0;
+    schedulerReset();
+    riotReset();
+    tiaReset();
+    audioReset();
+    cartLoad(nullptr, 0);
+    mapBus();
+    recompilerReset();
+    cycleBudget = 0;
+    rewindCount = 0;
   }
 
   /**
    * Load an Atari 2600 ROM into memory.
    *
+   * The bank-switching scheme is detected from the ROM's size and contents.
+   *
    * @param romData Pointer to a buffer containing the ROM.
-   * @param size    Size of the ROM in bytes (should be 4096 for a standard Atari 2600 ROM).
+   * @param size    Size of the ROM in bytes.
    */
   void loadProgram(uint8_t *romData, int size)
   {
-    if (size > 4096)
-    {
-      printf("Warning: ROM size (%d bytes) exceeds 4K. Only the first 4096 bytes will be used.\n", size);
-      size = 4096;
-    }
-    // Load the ROM into memory starting at 0xF000.
-    memcpy(memory + 0xF000, romData, size);
-    // Set the program counter to the start of the ROM.
-    pc = 0xF000;
+    cartLoad(romData, size);
+    mapBus();
+    recompilerReset();
+    rewindCount = 0;
 
-    if (verboseLogging)
+    // Start at the address in the reset vector ($FFFC), as the CPU does on power-up.
+    cpu.pc = busRead(0xFFFC) | (busRead(0xFFFD) << 8);
+    if (!(cpu.pc & 0x1000))
     {
-      printf("Loaded ROM into memory:\n");
-      for (int i = 0; i < size; i++)
-      {
-        printf("%02X ", memory[i]);
-        if ((i + 1) % 16 == 0)
-          printf("\n");
-      }
-      if (size % 16 != 0)
-        printf("\n");
+      printf("Warning: reset vector $%04X does not point into the cartridge. Starting at $F000.\n", cpu.pc);
+      cpu.pc = 0xF000;
     }
   }
 
   /**
-   * Emulate one CPU cycle for the Atari 2600.
+   * Run the CPU for the number of cycles that fit in the elapsed time.
    *
-   * Fetches an opcode from memory at pc, decodes it with a switch statement,
-   * and executes it. In our simplified implementation, if an STA instruction writes
-   * to address 0x09, we update COLUBK so the screen background will change.
+   * Instructions are executed until cpu.cycles reaches the cycle budget, at most
+   * MAX_FRAMES_PER_RUN frames' worth per call. The TIA draws the picture when its
+   * registers change and at the end of the run; the screen is updated whenever a frame
+   * completes.
    */
-  void emulateCycle()
+  void run(double deltaMs)
   {
-    // Fetch the opcode (1 byte) from memory at the current program counter.
-    uint8_t opcode = memory[pc];
-    switch (opcode)
-    {
-    // 0xA5: LDA Zero Page – Load the accumulator from a zero-page memory location.
-    case 0xA5:
-    {
-      uint8_t zp_addr = memory[pc + 1];
-      A = memory[zp_addr];
-      updateZeroFlag(A);
-      if (verboseLogging)
-        printf("LDA $%02X: Load accumulator from zero page address $%02X, A = 0x%02X at pc: 0x%04X\n",
-               zp_addr, zp_addr, A, pc);
-      pc += 2;
-      break;
-    }
+    cycleBudget += deltaMs * CYCLES_PER_MS;
+    if (cycleBudget > CYCLES_PER_FRAME * MAX_FRAMES_PER_RUN)
+      cycleBudget = CYCLES_PER_FRAME * MAX_FRAMES_PER_RUN;
 
-    // LDA immediate – Load accumulator with immediate value.
-    case 0xA9:
-    {
-      uint8_t operand = memory[pc + 1];
-      A = operand;
-      updateZeroFlag(A);
-      if (verboseLogging)
-        printf("LDA #$%02X: A = 0x%02X at pc: 0x%04X\n", operand, A, pc);
-      pc += 2;
-      break;
-    }
-    // LSR A – Logical shift right of the accumulator.
-    case 0x4A:
-    {
-      uint8_t carry = A & 0x01;
-      A >>= 1;
-      if (carry)
-        status |= 0x01;
-      else
-        status &= ~0x01;
-      updateZeroFlag(A);
-      if (verboseLogging)
-        printf("LSR A: A = 0x%02X at pc: 0x%04X\n", A, pc);
-      pc += 1;
-      break;
-    }
-    // EOR immediate – Exclusive OR accumulator with immediate value.
-    case 0x49:
-    {
-      uint8_t operand = memory[pc + 1];
-      A ^= operand;
-      updateZeroFlag(A);
-      if (verboseLogging)
-        printf("EOR #$%02X: A = 0x%02X at pc: 0x%04X\n", operand, A, pc);
-      pc += 2;
-      break;
-    }
-    // STA zero page – Store accumulator into a zero page address.
-    case 0x85:
-    {
-      uint8_t zp_addr = memory[pc + 1];
-      memory[zp_addr] = A;
-      // If writing to 0x08 or 0x09, update COLUBK.
-      if (zp_addr == 0x08 || zp_addr == 0x09)
-        COLUBK = A;
-      if (verboseLogging)
-        printf("STA $%02X: Stored A = 0x%02X at pc: 0x%04X\n", zp_addr, A, pc);
-      pc += 2;
-      break;
-    }
-    // LDY immediate – Load Y register with immediate value.
-    case 0xA0:
-    {
-      uint8_t operand = memory[pc + 1];
-      Y = operand;
-      updateZeroFlag(Y);
-      if (verboseLogging)
-        printf("LDY #$%02X: Y = 0x%02X at pc: 0x%04X\n", operand, Y, pc);
-      pc += 2;
-      break;
-    }
-    // LDX immediate – Load X register with immediate value.
-    case 0xA2:
-    {
-      uint8_t operand = memory[pc + 1];
-      X = operand;
-      updateZeroFlag(X);
-      if (verboseLogging)
-        printf("LDX #$%02X: X = 0x%02X at pc: 0x%04X\n", operand, X, pc);
-      pc += 2;
-      break;
-    }
-    // DEX – Decrement the X register.
-    case 0xCA:
-      X -= 1;
-      updateZeroFlag(X);
-      if (verboseLogging)
-        printf("DEX: X = 0x%02X at pc: 0x%04X\n", X, pc);
-      pc += 1;
-      break;
-    // BNE – Branch if Zero flag is clear.
-    case 0xD0:
-    {
-      int8_t offset = static_cast<int8_t>(memory[pc + 1]);
-      if ((status & 0x02) == 0)
-      {
-        if (verboseLogging)
-          printf("BNE: Branch taken, offset %d at pc: 0x%04X\n", offset, pc);
-        pc = pc + 2 + offset;
-      }
-      else
-      {
-        if (verboseLogging)
-          printf("BNE: Branch not taken at pc: 0x%04X\n", pc);
-        pc += 2;
-      }
-      break;
-    }
-    // DEY – Decrement the Y register.
-    case 0x88:
-      Y -= 1;
-      updateZeroFlag(Y);
-      if (verboseLogging)
-        printf("DEY: Y = 0x%02X at pc: 0x%04X\n", Y, pc);
-      pc += 1;
-      break;
-    // JMP Absolute – Jump to the absolute address specified by the next two bytes.
-    case 0x4C:
-    {
-      uint16_t addr = memory[pc + 1] | (memory[pc + 2] << 8);
-      if (verboseLogging)
-        printf("JMP $%04X: Jump to absolute address at pc: 0x%04X\n", addr, pc);
-      pc = addr;
-      break;
-    }
-      // 0xE6: INC Zero Page – Increment the memory value at a zero-page address.
-    case 0xE6:
-    {
-      uint8_t zp_addr = memory[pc + 1];
-      memory[zp_addr]++; // Increment the value at the specified zero-page address.
-      updateZeroFlag(memory[zp_addr]);
-      // Optionally update the Negative flag based on the result.
-      if (memory[zp_addr] & 0x80)
-        status |= 0x80;
-      else
-        status &= ~0x80;
-      if (verboseLogging)
-        printf("INC $%02X: Incremented memory at zero page address $%02X, new value = 0x%02X at pc: 0x%04X\n",
-               zp_addr, zp_addr, memory[zp_addr], pc);
-      pc += 2;
-      break;
-    }
-    // Default: Unsupported opcode.
-    default:
-      printf("Unsupported opcode: 0x%02X at pc: 0x%04X\n", opcode, pc);
-      pc += 1;
-      break;
-    }
+    uint64_t start = cpu.cycles;
+    uint64_t target = start + static_cast<uint64_t>(cycleBudget > 0 ? cycleBudget : 0);
+    runUntil(target, false);
+    tiaCatchUp(cpu.cycles);
+    audioCatchUp(cpu.cycles);
+    cycleBudget -= static_cast<double>(cpu.cycles - start);
   }
 
   /**
-   * Run a number of cycles based on the elapsed time.
+   * Run until the TIA finishes the current frame: the program starts VSYNC, or the frame
+   * reaches MAX_SCANLINES_PER_FRAME lines. Emulation stops right after the instruction that
+   * ends it, so the screen never shows a partly drawn frame. The new state is recorded for
+   * rewindFrames().
    *
-   * For simplicity, a fixed number of cycles are run per call.
-   * After running cycles, update the screen buffer using the current COLUBK value.
+   * @return The frame's FrameStatus. The pointer stays the same between calls.
    */
-  void run(double deltaMs)
+  FrameStatus *runFrame()
   {
-    int cyclesToRun = 1; // For simplicity, run one cycle per call.
-    bool normalMode = true;
-    if (normalMode)
-    {
-      // Calculate how many cycles to run given deltaMs.
-      const double cyclesPerMs = 1190.0; // Approximately 1,190 cycles per millisecond.
-      cyclesToRun = static_cast<int>(deltaMs * cyclesPerMs);
-    }
-    //  printf("Delta = %f, Running %d cycles\n", deltaMs, cyclesToRun);
-    for (int i = 0; i < cyclesToRun; i++)
+    emulateFrame();
+    rewindPush();
+    return &frameStatus;
+  }
+
+  /**
+   * Run one frame, then run ahead to cut input latency.
+   *
+   * After the real frame the state is saved and `frames` more frames are emulated with the
+   * current input. Only the last of them is presented, and they produce no sound; the state
+   * is then rolled back, so the screen shows that speculative frame while the real timeline
+   * is unaffected. With frames = 0 this is the same as runFrame().
+   *
+   * @param frames Number of frames to run ahead.
+   * @return The real frame's FrameStatus, with frameChanged for the presented frame.
+   */
+  FrameStatus *runAhead(int frames)
+  {
+    if (frames <= 0)
+      return runFrame();
+
+    renderEnabled = false;
+    runFrame();
+    stateSave(runAheadSnapshot);
+    FrameStatus status = frameStatus;
+    audioEnabled = false;
+    for (int i = 0; i < frames; i++)
     {
-      emulateCycle();
+      renderEnabled = (i == frames - 1);
+      emulateFrame();
     }
-    // Update the screen buffer with the current background color.
-    memset(screen, COLUBK, sizeof(screen));
+    status.frameChanged = frameStatus.frameChanged;
+    renderEnabled = true;
+    audioEnabled = true;
+    stateLoad(runAheadSnapshot);
+    frameStatus = status;
+    return &frameStatus;
+  }
+
+  /**
+   * Step back up to `frames` frames, as far as the rewind buffer reaches, and show the
+   * frame rewound to. It is emulated again from the snapshot before it, without sound.
+   *
+   * @return The number of frames rewound.
+   */
+  int rewindFrames(int frames)
+  {
+    if (frames > rewindCount - 2)
+      frames = rewindCount - 2;
+    if (frames <= 0)
+      return 0;
+
+    for (int i = 0; i < frames; i++)
+      rewindPop();
+    stateLoad(rewindPop());
+    audioEnabled = false;
+    emulateFrame();
+    audioEnabled = true;
+    rewindPush();
+    return frames;
+  }
+
+  /**
+   * Get the size of a snapshot in bytes.
+   */
+  int getSnapshotSize()
+  {
+    return sizeof(SaveState);
+  }
 
-    // Overlay the playfield pattern.
-    overlayPlayfield();
+  /**
+   * Take a snapshot of the machine (see state.h), best between frames. The ROM is not
+   * included, only its hash.
+   *
+   * @return Pointer to getSnapshotSize() bytes, valid until the next call.
+   */
+  const uint8_t *saveSnapshot()
+  {
+    stateSave(exportedSnapshot);
+    return reinterpret_cast<const uint8_t *>(&exportedSnapshot);
   }
 
   /**
-   * Get a pointer to the current screen buffer.
+   * Restore a snapshot from saveSnapshot(). The rewind history starts over from it.
    *
-   * The returned buffer contains one 8‑bit value per pixel (grayscale).
+   * @return 1 on success; 0 if the data is not a snapshot of this version or was taken with
+   *         a different ROM, in which case nothing changes.
+   */
+  int loadSnapshot(const uint8_t *data, int size)
+  {
+    if (!stateLoadChecked(data, size))
+      return 0;
+    rewindCount = 0;
+    rewindPush();
+    return 1;
+  }
+
+  /**
+   * Get a pointer to the current screen, one colour register value per pixel.
+   *
+   * The frontend maps the values to colours with the table from getPalette().
    */
   uint8_t *getScreen()
   {
-    for (int i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++)
-    {
-      uint8_t pixel = screen[i];
-      int index = pixel / 16; // Scale 0–255 to 0–15.
-      if (index < 0 || index >= PALETTE_SIZE)
-      {
-        // Fallback: use magenta.
-        rgbScreen[i * 3 + 0] = 255;
-        rgbScreen[i * 3 + 1] = 0;
-        rgbScreen[i * 3 + 2] = 255;
-      }
-      else
-      {
-        rgbScreen[i * 3 + 0] = palette[index].r;
-        rgbScreen[i * 3 + 1] = palette[index].g;
-        rgbScreen[i * 3 + 2] = palette[index].b;
-      }
-    }
-    return rgbScreen;
+    return screen;
+  }
+
+  /**
+   * Get the palette for the current screen: 256 RGBA entries, 4 bytes each, indexed by the
+   * values in getScreen(). The pointer only changes when the palette does.
+   */
+  const uint32_t *getPalette()
+  {
+    Region region = selectedRegion;
+    if (region == REGION_AUTO)
+      region = tia.frameScanlines > PAL_MIN_SCANLINES ? REGION_PAL : REGION_NTSC;
+    return paletteFor(region);
+  }
+
+  /**
+   * Select the palette: 0 = automatic (NTSC or PAL by frame length), 1 = NTSC, 2 = PAL,
+   * 3 = SECAM.
+   */
+  void setPalette(int region)
+  {
+    if (region >= REGION_AUTO && region <= REGION_SECAM)
+      selectedRegion = static_cast<Region>(region);
+  }
+
+  /**
+   * Enable audio synthesis at the host sample rate.
+   *
+   * @param sampleRate Sample rate of the host AudioContext in Hz.
+   * @return Pointer to the AudioRing the AudioWorklet should drain.
+   */
+  AudioRing *initAudio(int sampleRate)
+  {
+    return audioStart(sampleRate);
   }
 
   /**
@@ -414,4 +449,44 @@ extern "C"
   {
     return SCREEN_HEIGHT;
   }
-} // extern "C"
\ No newline at end of file
+
+  // Mark a key (see Key) as pressed.
+  void setKeyDown(int key)
+  {
+    if (key >= 0 && key < KEY_COUNT)
+    {
+      *KEY_PINS[key].pins &= ~KEY_PINS[key].mask;
+    }
+  }
+
+  // Mark a key as released.
+  void setKeyUp(int key)
+  {
+    if (key >= 0 && key < KEY_COUNT)
+    {
+      *KEY_PINS[key].pins |= KEY_PINS[key].mask;
+    }
+  }
+
+#ifdef ATARI2600_TRACE
+  /**
+   * Get the instruction trace, oldest record first. getTraceLength() records of 24 bytes
+   * each (TraceRecord in trace.h); tools/atari2600/disassemble-trace.js formats them.
+   */
+  const TraceRecord *getTrace()
+  {
+    return traceRecords();
+  }
+
+  int getTraceLength()
+  {
+    return traceLength();
+  }
+
+  // Discard the recorded instructions.
+  void clearTrace()
+  {
+    traceClear();
+  }
+#endif
+} // extern "C"
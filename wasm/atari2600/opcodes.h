@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstdint>
+
+// ----- Opcode Table -----
+// Every opcode is described by its operation, addressing mode and base cycle count. The
+// interpreter's handlers (cpu6502.cpp) are generated from this table at compile time, one
+// per opcode, and the block recompiler (recompiler.cpp) translates from it.
+
+enum class Mode : uint8_t
+{
+  Implied,
+  Accumulator,
+  Immediate,
+  ZeroPage,
+  ZeroPageX,
+  ZeroPageY,
+  Absolute,
+  AbsoluteX,
+  AbsoluteY,
+  Indirect,  // JMP ($nnnn)
+  IndirectX, // ($nn,X)
+  IndirectY, // ($nn),Y
+  Relative,  // Branches
+};
+
+enum class Op : uint8_t
+{
+  ADC, AND, ASL, BCC, BCS, BEQ, BIT, BMI, BNE, BPL, BRK, BVC, BVS, CLC,
+  CLD, CLI, CLV, CMP, CPX, CPY, DEC, DEX, DEY, EOR, INC, INX, INY, JMP,
+  JSR, LDA, LDX, LDY, LSR, NOP, ORA, PHA, PHP, PLA, PLP, ROL, ROR, RTI,
+  RTS, SBC, SEC, SED, SEI, STA, STX, STY, TAX, TAY, TSX, TXA, TXS, TYA,
+  // Undocumented operations of the NMOS 6502
+  ALR, ANC, ANE, ARR, DCP, ISB, JAM, LAS, LAX, LXA, RLA, RRA, SAX, SBX,
+  SHA, SHX, SHY, SLO, SRE, TAS,
+};
+
+struct OpcodeInfo
+{
+  Op op;
+  Mode mode;
+  uint8_t cycles; // Base cycle count, without page-crossing or branch penalties
+};
+
+#define O(op, mode, cycles) {Op::op, Mode::mode, cycles}
+#define JAM O(JAM, Implied, 2)
+
+// clang-format off
+static constexpr OpcodeInfo OPCODES[256] = {
+  /* 0x */ O(BRK, Implied, 7), O(ORA, IndirectX, 6), JAM, O(SLO, IndirectX, 8), O(NOP, ZeroPage, 3), O(ORA, ZeroPage, 3), O(ASL, ZeroPage, 5), O(SLO, ZeroPage, 5),
+           O(PHP, Implied, 3), O(ORA, Immediate, 2), O(ASL, Accumulator, 2), O(ANC, Immediate, 2), O(NOP, Absolute, 4), O(ORA, Absolute, 4), O(ASL, Absolute, 6), O(SLO, Absolute, 6),
+  /* 1x */ O(BPL, Relative, 2), O(ORA, IndirectY, 5), JAM, O(SLO, IndirectY, 8), O(NOP, ZeroPageX, 4), O(ORA, ZeroPageX, 4), O(ASL, ZeroPageX, 6), O(SLO, ZeroPageX, 6),
+           O(CLC, Implied, 2), O(ORA, AbsoluteY, 4), O(NOP, Implied, 2), O(SLO, AbsoluteY, 7), O(NOP, AbsoluteX, 4), O(ORA, AbsoluteX, 4), O(ASL, AbsoluteX, 7), O(SLO, AbsoluteX, 7),
+  /* 2x */ O(JSR, Absolute, 6), O(AND, IndirectX, 6), JAM, O(RLA, IndirectX, 8), O(BIT, ZeroPage, 3), O(AND, ZeroPage, 3), O(ROL, ZeroPage, 5), O(RLA, ZeroPage, 5),
+           O(PLP, Implied, 4), O(AND, Immediate, 2), O(ROL, Accumulator, 2), O(ANC, Immediate, 2), O(BIT, Absolute, 4), O(AND, Absolute, 4), O(ROL, Absolute, 6), O(RLA, Absolute, 6),
+  /* 3x */ O(BMI, Relative, 2), O(AND, IndirectY, 5), JAM, O(RLA, IndirectY, 8), O(NOP, ZeroPageX, 4), O(AND, ZeroPageX, 4), O(ROL, ZeroPageX, 6), O(RLA, ZeroPageX, 6),
+           O(SEC, Implied, 2), O(AND, AbsoluteY, 4), O(NOP, Implied, 2), O(RLA, AbsoluteY, 7), O(NOP, AbsoluteX, 4), O(AND, AbsoluteX, 4), O(ROL, AbsoluteX, 7), O(RLA, AbsoluteX, 7),
+  /* 4x */ O(RTI, Implied, 6), O(EOR, IndirectX, 6), JAM, O(SRE, IndirectX, 8), O(NOP, ZeroPage, 3), O(EOR, ZeroPage, 3), O(LSR, ZeroPage, 5), O(SRE, ZeroPage, 5),
+           O(PHA, Implied, 3), O(EOR, Immediate, 2), O(LSR, Accumulator, 2), O(ALR, Immediate, 2), O(JMP, Absolute, 3), O(EOR, Absolute, 4), O(LSR, Absolute, 6), O(SRE, Absolute, 6),
+  /* 5x */ O(BVC, Relative, 2), O(EOR, IndirectY, 5), JAM, O(SRE, IndirectY, 8), O(NOP, ZeroPageX, 4), O(EOR, ZeroPageX, 4), O(LSR, ZeroPageX, 6), O(SRE, ZeroPageX, 6),
+           O(CLI, Implied, 2), O(EOR, AbsoluteY, 4), O(NOP, Implied, 2), O(SRE, AbsoluteY, 7), O(NOP, AbsoluteX, 4), O(EOR, AbsoluteX, 4), O(LSR, AbsoluteX, 7), O(SRE, AbsoluteX, 7),
+  /* 6x */ O(RTS, Implied, 6), O(ADC, IndirectX, 6), JAM, O(RRA, IndirectX, 8), O(NOP, ZeroPage, 3), O(ADC, ZeroPage, 3), O(ROR, ZeroPage, 5), O(RRA, ZeroPage, 5),
+           O(PLA, Implied, 4), O(ADC, Immediate, 2), O(ROR, Accumulator, 2), O(ARR, Immediate, 2), O(JMP, Indirect, 5), O(ADC, Absolute, 4), O(ROR, Absolute, 6), O(RRA, Absolute, 6),
+  /* 7x */ O(BVS, Relative, 2), O(ADC, IndirectY, 5), JAM, O(RRA, IndirectY, 8), O(NOP, ZeroPageX, 4), O(ADC, ZeroPageX, 4), O(ROR, ZeroPageX, 6), O(RRA, ZeroPageX, 6),
+           O(SEI, Implied, 2), O(ADC, AbsoluteY, 4), O(NOP, Implied, 2), O(RRA, AbsoluteY, 7), O(NOP, AbsoluteX, 4), O(ADC, AbsoluteX, 4), O(ROR, AbsoluteX, 7), O(RRA, AbsoluteX, 7),
+  /* 8x */ O(NOP, Immediate, 2), O(STA, IndirectX, 6), O(NOP, Immediate, 2), O(SAX, IndirectX, 6), O(STY, ZeroPage, 3), O(STA, ZeroPage, 3), O(STX, ZeroPage, 3), O(SAX, ZeroPage, 3),
+           O(DEY, Implied, 2), O(NOP, Immediate, 2), O(TXA, Implied, 2), O(ANE, Immediate, 2), O(STY, Absolute, 4), O(STA, Absolute, 4), O(STX, Absolute, 4), O(SAX, Absolute, 4),
+  /* 9x */ O(BCC, Relative, 2), O(STA, IndirectY, 6), JAM, O(SHA, IndirectY, 6), O(STY, ZeroPageX, 4), O(STA, ZeroPageX, 4), O(STX, ZeroPageY, 4), O(SAX, ZeroPageY, 4),
+           O(TYA, Implied, 2), O(STA, AbsoluteY, 5), O(TXS, Implied, 2), O(TAS, AbsoluteY, 5), O(SHY, AbsoluteX, 5), O(STA, AbsoluteX, 5), O(SHX, AbsoluteY, 5), O(SHA, AbsoluteY, 5),
+  /* Ax */ O(LDY, Immediate, 2), O(LDA, IndirectX, 6), O(LDX, Immediate, 2), O(LAX, IndirectX, 6), O(LDY, ZeroPage, 3), O(LDA, ZeroPage, 3), O(LDX, ZeroPage, 3), O(LAX, ZeroPage, 3),
+           O(TAY, Implied, 2), O(LDA, Immediate, 2), O(TAX, Implied, 2), O(LXA, Immediate, 2), O(LDY, Absolute, 4), O(LDA, Absolute, 4), O(LDX, Absolute, 4), O(LAX, Absolute, 4),
+  /* Bx */ O(BCS, Relative, 2), O(LDA, IndirectY, 5), JAM, O(LAX, IndirectY, 5), O(LDY, ZeroPageX, 4), O(LDA, ZeroPageX, 4), O(LDX, ZeroPageY, 4), O(LAX, ZeroPageY, 4),
+           O(CLV, Implied, 2), O(LDA, AbsoluteY, 4), O(TSX, Implied, 2), O(LAS, AbsoluteY, 4), O(LDY, AbsoluteX, 4), O(LDA, AbsoluteX, 4), O(LDX, AbsoluteY, 4), O(LAX, AbsoluteY, 4),
+  /* Cx */ O(CPY, Immediate, 2), O(CMP, IndirectX, 6), O(NOP, Immediate, 2), O(DCP, IndirectX, 8), O(CPY, ZeroPage, 3), O(CMP, ZeroPage, 3), O(DEC, ZeroPage, 5), O(DCP, ZeroPage, 5),
+           O(INY, Implied, 2), O(CMP, Immediate, 2), O(DEX, Implied, 2), O(SBX, Immediate, 2), O(CPY, Absolute, 4), O(CMP, Absolute, 4), O(DEC, Absolute, 6), O(DCP, Absolute, 6),
+  /* Dx */ O(BNE, Relative, 2), O(CMP, IndirectY, 5), JAM, O(DCP, IndirectY, 8), O(NOP, ZeroPageX, 4), O(CMP, ZeroPageX, 4), O(DEC, ZeroPageX, 6), O(DCP, ZeroPageX, 6),
+           O(CLD, Implied, 2), O(CMP, AbsoluteY, 4), O(NOP, Implied, 2), O(DCP, AbsoluteY, 7), O(NOP, AbsoluteX, 4), O(CMP, AbsoluteX, 4), O(DEC, AbsoluteX, 7), O(DCP, AbsoluteX, 7),
+  /* Ex */ O(CPX, Immediate, 2), O(SBC, IndirectX, 6), O(NOP, Immediate, 2), O(ISB, IndirectX, 8), O(CPX, ZeroPage, 3), O(SBC, ZeroPage, 3), O(INC, ZeroPage, 5), O(ISB, ZeroPage, 5),
+           O(INX, Implied, 2), O(SBC, Immediate, 2), O(NOP, Implied, 2), O(SBC, Immediate, 2), O(CPX, Absolute, 4), O(SBC, Absolute, 4), O(INC, Absolute, 6), O(ISB, Absolute, 6),
+  /* Fx */ O(BEQ, Relative, 2), O(SBC, IndirectY, 5), JAM, O(ISB, IndirectY, 8), O(NOP, ZeroPageX, 4), O(SBC, ZeroPageX, 4), O(INC, ZeroPageX, 6), O(ISB, ZeroPageX, 6),
+           O(SED, Implied, 2), O(SBC, AbsoluteY, 4), O(NOP, Implied, 2), O(ISB, AbsoluteY, 7), O(NOP, AbsoluteX, 4), O(SBC, AbsoluteX, 4), O(INC, AbsoluteX, 7), O(ISB, AbsoluteX, 7),
+};
+// clang-format on
+
+#undef O
+#undef JAM
+
+// ----- Operation Classes -----
+// How an operation uses its operand decides how the handler accesses memory.
+
+// Store the result of a register to memory.
+constexpr bool isStore(Op op)
+{
+  return op == Op::STA || op == Op::STX || op == Op::STY || op == Op::SAX;
+}
+
+// Stores of a register ANDed with the high byte of the target address plus one.
+constexpr bool isHighByteStore(Op op)
+{
+  return op == Op::SHA || op == Op::SHX || op == Op::SHY || op == Op::TAS;
+}
+
+// The undocumented read-modify-write operations run a documented one and then feed its
+// result to a read operation: SLO is ASL then ORA, DCP is DEC then CMP, and so on.
+constexpr Op modifyPart(Op op)
+{
+  switch (op)
+  {
+  case Op::SLO: return Op::ASL;
+  case Op::RLA: return Op::ROL;
+  case Op::SRE: return Op::LSR;
+  case Op::RRA: return Op::ROR;
+  case Op::DCP: return Op::DEC;
+  case Op::ISB: return Op::INC;
+  default: return op;
+  }
+}
+
+constexpr Op readPart(Op op)
+{
+  switch (op)
+  {
+  case Op::SLO: return Op::ORA;
+  case Op::RLA: return Op::AND;
+  case Op::SRE: return Op::EOR;
+  case Op::RRA: return Op::ADC;
+  case Op::DCP: return Op::CMP;
+  case Op::ISB: return Op::SBC;
+  default: return Op::NOP;
+  }
+}
+
+// Read a value from memory, modify it and write it back.
+constexpr bool isReadModifyWrite(Op op)
+{
+  op = modifyPart(op);
+  return op == Op::ASL || op == Op::LSR || op == Op::ROL || op == Op::ROR || op == Op::INC || op == Op::DEC;
+}
+
+// Indexed reads take an extra cycle when indexing crosses a page. Stores and read-modify-write
+// instructions always spend that cycle, so it is already part of their base count.
+constexpr bool hasPageCrossPenalty(Op op)
+{
+  return !isStore(op) && !isHighByteStore(op) && !isReadModifyWrite(op);
+}
@@ -0,0 +1,90 @@
+#include <array>
+
+#include "palette.h"
+
+// The 128 colours of each encoding as 0xRRGGBB, in colour register order (hue in the
+// high nibble, luminance in bits 3-1).
+
+// clang-format off
+static constexpr uint32_t NTSC_RGB[128] = {
+  0x000000, 0x4A4A4A, 0x6F6F6F, 0x8E8E8E, 0xAAAAAA, 0xC0C0C0, 0xD6D6D6, 0xECECEC,
+  0x484800, 0x69690F, 0x86861D, 0xA2A22A, 0xBBBB35, 0xD2D240, 0xE8E84A, 0xFCFC54,
+  0x7C2C00, 0x904811, 0xA26221, 0xB47A30, 0xC3903D, 0xD2A44A, 0xDFB755, 0xECC860,
+  0x901C00, 0xA33915, 0xB55328, 0xC66C3A, 0xD5824A, 0xE39759, 0xF0AA67, 0xFCBC74,
+  0x940000, 0xA71A1A, 0xB83232, 0xC84848, 0xD65C5C, 0xE46F6F, 0xF08080, 0xFC9090,
+  0x840064, 0x97197A, 0xA8308F, 0xB846A2, 0xC659B3, 0xD46CC3, 0xE07CD2, 0xEC8CE0,
+  0x500084, 0x68199A, 0x7D30AD, 0x9246C0, 0xA459D0, 0xB56CE0, 0xC57CEE, 0xD48CFC,
+  0x140090, 0x331AA3, 0x4E32B5, 0x6848C6, 0x7F5CD5, 0x956FE3, 0xA980F0, 0xBC90FC,
+  0x000094, 0x181AA7, 0x2D32B8, 0x4248C8, 0x545CD6, 0x656FE4, 0x7580F0, 0x8490FC,
+  0x001C88, 0x183B9D, 0x2D57B0, 0x4272C2, 0x548AD2, 0x65A0E1, 0x75B5EF, 0x84C8FC,
+  0x003064, 0x185080, 0x2D6D98, 0x4288B0, 0x54A0C5, 0x65B7D9, 0x75CCEB, 0x84E0FC,
+  0x004030, 0x18624E, 0x2D8169, 0x429E82, 0x54B899, 0x65D1AE, 0x75E7C2, 0x84FCD4,
+  0x004400, 0x1A661A, 0x328432, 0x48A048, 0x5CBA5C, 0x6FD26F, 0x80E880, 0x90FC90,
+  0x143C00, 0x355F18, 0x527E2D, 0x6E9C42, 0x87B754, 0x9ED065, 0xB4E775, 0xC8FC84,
+  0x303800, 0x505916, 0x6D762B, 0x88923E, 0xA0AB4F, 0xB7C25F, 0xCCD86E, 0xE0EC7C,
+  0x482C00, 0x694D14, 0x866A26, 0xA28638, 0xBB9F47, 0xD2B656, 0xE8CC63, 0xFCE070,
+};
+
+static constexpr uint32_t PAL_RGB[128] = {
+  0x000000, 0x282828, 0x505050, 0x747474, 0x949494, 0xB4B4B4, 0xD0D0D0, 0xECECEC,
+  0x000000, 0x282828, 0x505050, 0x747474, 0x949494, 0xB4B4B4, 0xD0D0D0, 0xECECEC,
+  0x805800, 0x947020, 0xA8843C, 0xBC9C58, 0xCCAC70, 0xDCC084, 0xECD09C, 0xFCE0B0,
+  0x445C00, 0x5C7820, 0x74903C, 0x8CAC58, 0xA0C070, 0xB0D484, 0xC4E89C, 0xD4FCB0,
+  0x703400, 0x885020, 0xA0683C, 0xB48458, 0xC89870, 0xDCAC84, 0xECC09C, 0xFCD4B0,
+  0x006414, 0x208034, 0x3C9850, 0x58B06C, 0x70C484, 0x84D89C, 0x9CE8B4, 0xB0FCC8,
+  0x700014, 0x882034, 0xA03C50, 0xB4586C, 0xC87084, 0xDC849C, 0xEC9CB4, 0xFCB0C8,
+  0x005C5C, 0x207474, 0x3C8C8C, 0x58A4A4, 0x70B8B8, 0x84C8C8, 0x9CDCDC, 0xB0ECEC,
+  0x70005C, 0x842074, 0x943C88, 0xA8589C, 0xB470B0, 0xC484C0, 0xD09CD0, 0xE0B0E0,
+  0x003C70, 0x1C5888, 0x3874A0, 0x508CB4, 0x68A4C8, 0x7CB8DC, 0x90CCEC, 0xA4E0FC,
+  0x580070, 0x6C2088, 0x803CA0, 0x9458B4, 0xA470C8, 0xB484DC, 0xC49CEC, 0xD4B0FC,
+  0x002070, 0x1C3C88, 0x3858A0, 0x5074B4, 0x6888C8, 0x7CA0DC, 0x90B4EC, 0xA4C8FC,
+  0x3C0080, 0x542094, 0x6C3CA8, 0x8058BC, 0x9470CC, 0xA884DC, 0xB89CEC, 0xC8B0FC,
+  0x000088, 0x20209C, 0x3C3CB0, 0x5858C0, 0x7070D0, 0x8484E0, 0x9C9CEC, 0xB0B0FC,
+  0x000000, 0x282828, 0x505050, 0x747474, 0x949494, 0xB4B4B4, 0xD0D0D0, 0xECECEC,
+  0x000000, 0x282828, 0x505050, 0x747474, 0x949494, 0xB4B4B4, 0xD0D0D0, 0xECECEC,
+};
+// clang-format on
+
+// SECAM has no hue: the luminance bits alone pick one of eight colours.
+static constexpr uint32_t SECAM_RGB[8] = {
+    0x000000, 0x2121FF, 0xF03C79, 0xFF50FF, 0x7FFF00, 0x7FFFFF, 0xFFFF3F, 0xFFFFFF,
+};
+
+static constexpr uint32_t rgba(uint32_t rgb)
+{
+  return 0xFF000000 | ((rgb & 0xFF) << 16) | (rgb & 0xFF00) | ((rgb >> 16) & 0xFF);
+}
+
+// Expand 128 colours to the 256 colour register values.
+static constexpr std::array<uint32_t, 256> expand(const uint32_t (&colours)[128])
+{
+  std::array<uint32_t, 256> table{};
+  for (int i = 0; i < 256; i++)
+    table[i] = rgba(colours[i >> 1]);
+  return table;
+}
+
+static constexpr std::array<uint32_t, 256> expandSecam()
+{
+  std::array<uint32_t, 256> table{};
+  for (int i = 0; i < 256; i++)
+    table[i] = rgba(SECAM_RGB[(i >> 1) & 7]);
+  return table;
+}
+
+static constexpr std::array<uint32_t, 256> NTSC_PALETTE = expand(NTSC_RGB);
+static constexpr std::array<uint32_t, 256> PAL_PALETTE = expand(PAL_RGB);
+static constexpr std::array<uint32_t, 256> SECAM_PALETTE = expandSecam();
+
+const uint32_t *paletteFor(Region region)
+{
+  switch (region)
+  {
+  case REGION_PAL:
+    return PAL_PALETTE.data();
+  case REGION_SECAM:
+    return SECAM_PALETTE.data();
+  default:
+    return NTSC_PALETTE.data();
+  }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+// Colour encodings of the TIA. The frame's scanline count tells NTSC from PAL; SECAM
+// consoles run PAL timing, so they have to be chosen explicitly.
+enum Region
+{
+  REGION_AUTO,
+  REGION_NTSC,
+  REGION_PAL,
+  REGION_SECAM,
+};
+
+// Frames with more scanlines than this are taken to be PAL (312 lines nominal).
+const int PAL_MIN_SCANLINES = 288;
+
+/**
+ * Palette for a region, indexed by a colour register value. Entries are RGBA32 with red in
+ * the lowest byte, so each one is stored as R, G, B, A in memory. Bit 0 of the colour
+ * register is unused, so entries come in identical pairs.
+ */
+const uint32_t *paletteFor(Region region);
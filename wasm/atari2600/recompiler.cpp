@@ -0,0 +1,1283 @@
+#include <cstddef>
+#include <cstring>
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten.h>
+#endif
+
+#include "bus.h"
+#include "cart.h"
+#include "cpu6502.h"
+#include "opcodes.h"
+#include "recompiler.h"
+#include "scheduler.h"
+
+#if defined(__EMSCRIPTEN__) && !defined(ATARI2600_TRACE)
+bool recompilerEnabled = true;
+#else
+bool recompilerEnabled = false;
+#endif
+
+// ----- Limits -----
+
+// Times the start of a block is reached before it is translated.
+const int HOT_THRESHOLD = 8;
+const int MAX_BLOCKS = 4096;
+const int MAX_BLOCK_INSTRUCTIONS = 48;
+// Browsers only compile modules of up to 4 KB synchronously on the main thread, so blocks
+// stop growing when their code passes MAX_CODE_SIZE.
+const int MAX_MODULE_SIZE = 4096;
+const int MAX_CODE_SIZE = 3584;
+
+// ----- Block Cache -----
+
+using BlockFunction = void (*)();
+
+struct Block
+{
+  BlockFunction run;
+  uint16_t start;     // Address the block was translated at
+  uint16_t maxCycles; // Cycles of the longest path through the block
+};
+
+// blockAt value for code that cannot start a block.
+const uint16_t NO_BLOCK = 0xFFFF;
+
+static Block blocks[MAX_BLOCKS]; // Entry 0 is unused
+static int blockCount = 1;
+// Per ROM byte: the index of the block starting there (0 until translated) and how often
+// it has been reached.
+static uint16_t blockAt[MAX_ROM_SIZE];
+static uint8_t heat[MAX_ROM_SIZE];
+
+// ----- Loading Code -----
+
+#ifdef __EMSCRIPTEN__
+// Compile a module and add its "run" export to the function table, so that the table index
+// can be called as a C function pointer. Returns 0 if the browser refuses the code.
+EM_JS(int, installBlock, (const uint8_t *code, int size), {
+  try {
+    const module = new WebAssembly.Module(HEAPU8.slice(code, code + size));
+    const instance = new WebAssembly.Instance(module, {env: {memory: wasmMemory}});
+    return addFunction(instance.exports.run, 'v');
+  } catch (e) {
+    return 0;
+  }
+});
+
+EM_JS(void, releaseBlock, (int index), { removeFunction(index); });
+
+EM_JS(int, memoryIsShared, (), {
+  return typeof SharedArrayBuffer !== 'undefined' && wasmMemory.buffer instanceof SharedArrayBuffer;
+});
+#else
+// Outside the browser there is no way to load the generated code.
+static int installBlock(const uint8_t *, int) { return 0; }
+static void releaseBlock(int) {}
+static int memoryIsShared() { return 0; }
+#endif
+
+// ----- Memory Layout -----
+// Generated code reaches the emulator through absolute addresses in linear memory.
+
+struct Layout
+{
+  // Fields of cpu.
+  uint32_t pc, A, X, Y, status, SP, zResult, nResult, cycles;
+  // busPages, the size of a BusPage and the offsets of its pointers.
+  uint32_t pages, pageStride, pageRead, pageWrite;
+  bool sharedMemory;
+};
+
+static Layout layout;
+
+static uint32_t linearAddress(const void *pointer)
+{
+  return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(pointer));
+}
+
+static void computeLayout()
+{
+  layout.pc = linearAddress(&cpu.pc);
+  layout.A = linearAddress(&cpu.A);
+  layout.X = linearAddress(&cpu.X);
+  layout.Y = linearAddress(&cpu.Y);
+  layout.status = linearAddress(&cpu.status);
+  layout.SP = linearAddress(&cpu.SP);
+  layout.zResult = linearAddress(&cpu.zResult);
+  layout.nResult = linearAddress(&cpu.nResult);
+  layout.cycles = linearAddress(&cpu.cycles);
+  layout.pages = linearAddress(busPages);
+  layout.pageStride = sizeof(BusPage);
+  layout.pageRead = offsetof(BusPage, read);
+  layout.pageWrite = offsetof(BusPage, write);
+  layout.sharedMemory = memoryIsShared();
+}
+
+// ----- WebAssembly Encoding -----
+
+enum WasmOp : uint8_t
+{
+  WASM_BLOCK = 0x02,
+  WASM_IF = 0x04,
+  WASM_END = 0x0B,
+  WASM_BR = 0x0C,
+  WASM_BR_IF = 0x0D,
+  WASM_LOCAL_GET = 0x20,
+  WASM_LOCAL_SET = 0x21,
+  WASM_LOCAL_TEE = 0x22,
+  WASM_I32_LOAD = 0x28,
+  WASM_I64_LOAD = 0x29,
+  WASM_I32_LOAD8_U = 0x2D,
+  WASM_I64_STORE = 0x37,
+  WASM_I32_STORE8 = 0x3A,
+  WASM_I32_STORE16 = 0x3B,
+  WASM_I32_CONST = 0x41,
+  WASM_I32_EQZ = 0x45,
+  WASM_I32_GE_U = 0x4F,
+  WASM_I32_ADD = 0x6A,
+  WASM_I32_SUB = 0x6B,
+  WASM_I32_MUL = 0x6C,
+  WASM_I32_AND = 0x71,
+  WASM_I32_OR = 0x72,
+  WASM_I32_XOR = 0x73,
+  WASM_I32_SHL = 0x74,
+  WASM_I32_SHR_U = 0x76,
+  WASM_I64_ADD = 0x7C,
+  WASM_I64_EXTEND_I32_U = 0xAD,
+  WASM_VOID = 0x40,
+  WASM_TYPE_I32 = 0x7F,
+};
+
+struct CodeBuffer
+{
+  uint8_t bytes[MAX_MODULE_SIZE];
+  int size;
+
+  void byte(uint8_t value)
+  {
+    if (size < MAX_MODULE_SIZE)
+      bytes[size] = value;
+    size++;
+  }
+
+  // Unsigned LEB128.
+  void u32(uint32_t value)
+  {
+    do
+    {
+      uint8_t low = value & 0x7F;
+      value >>= 7;
+      byte(value ? low | 0x80 : low);
+    } while (value);
+  }
+
+  // Signed LEB128.
+  void s32(int32_t value)
+  {
+    for (;;)
+    {
+      uint8_t low = value & 0x7F;
+      value >>= 7;
+      if ((value == 0 && !(low & 0x40)) || (value == -1 && (low & 0x40)))
+      {
+        byte(low);
+        return;
+      }
+      byte(low | 0x80);
+    }
+  }
+
+  void name(const char *text)
+  {
+    int length = static_cast<int>(strlen(text));
+    u32(length);
+    for (int i = 0; i < length; i++)
+      byte(text[i]);
+  }
+
+  void append(const CodeBuffer &other)
+  {
+    for (int i = 0; i < other.size; i++)
+      byte(other.bytes[i]);
+  }
+};
+
+static CodeBuffer code;   // Body of the function being translated
+static CodeBuffer module; // The finished module
+
+// ----- Code Generation -----
+// The registers are copied into locals on entry. All exits go through one wasm block: an
+// exit sets exitPc and exitCycles and branches out of it, and the code after it stores the
+// registers back and adds the cycles, including the page-crossing penalties collected in
+// extraCycles.
+
+enum Local : uint8_t
+{
+  LOCAL_A,
+  LOCAL_X,
+  LOCAL_Y,
+  LOCAL_SP,
+  LOCAL_P,    // cpu.status
+  LOCAL_Z,    // cpu.zResult
+  LOCAL_N,    // cpu.nResult
+  LOCAL_EXTRA_CYCLES,
+  LOCAL_EXIT_PC,
+  LOCAL_EXIT_CYCLES,
+  LOCAL_ADDRESS, // Bus address of the current access
+  LOCAL_POINTER, // Host memory of its page
+  LOCAL_VALUE,
+  LOCAL_TEMP,
+  LOCAL_HOST,    // Host address of a checked stack slot
+  LOCAL_PENALTY, // Page-crossing cycle of the current instruction
+  LOCAL_COUNT
+};
+
+// Wasm blocks and ifs open inside the exit block, for branch depths.
+static int nesting;
+
+static void op(uint8_t opcode) { code.byte(opcode); }
+
+static void get(Local local)
+{
+  op(WASM_LOCAL_GET);
+  code.u32(local);
+}
+
+static void set(Local local)
+{
+  op(WASM_LOCAL_SET);
+  code.u32(local);
+}
+
+static void tee(Local local)
+{
+  op(WASM_LOCAL_TEE);
+  code.u32(local);
+}
+
+static void constant(int32_t value)
+{
+  op(WASM_I32_CONST);
+  code.s32(value);
+}
+
+// A load or store at an absolute address plus the address on the stack.
+static void memory(uint8_t opcode, uint32_t offset)
+{
+  op(opcode);
+  code.u32(0); // Alignment hint: byte-aligned is always valid
+  code.u32(offset);
+}
+
+// Load a byte field of the CPU into a local, and store it back.
+static void loadField(Local local, uint32_t address)
+{
+  constant(0);
+  memory(WASM_I32_LOAD8_U, address);
+  set(local);
+}
+
+static void storeField(Local local, uint32_t address)
+{
+  constant(0);
+  get(local);
+  memory(WASM_I32_STORE8, address);
+}
+
+// Set a local from the value on the stack masked to 8 bits.
+static void setByte(Local local)
+{
+  constant(0xFF);
+  op(WASM_I32_AND);
+  set(local);
+}
+
+// Set Z and N from a local, as setNZ() does.
+static void setNZ(Local local)
+{
+  get(local);
+  tee(LOCAL_Z);
+  set(LOCAL_N);
+}
+
+// Replace the status bits in `mask` with the value on the stack (which has no other bits).
+static void setFlags(uint8_t mask)
+{
+  get(LOCAL_P);
+  constant(~mask & 0xFF);
+  op(WASM_I32_AND);
+  op(WASM_I32_OR);
+  set(LOCAL_P);
+}
+
+static void setExit(uint16_t pc, int cycles)
+{
+  constant(pc);
+  set(LOCAL_EXIT_PC);
+  constant(cycles);
+  set(LOCAL_EXIT_CYCLES);
+}
+
+// Leave the block for the instruction at `pc`, `cycles` base cycles after the start.
+static void exitTo(uint16_t pc, int cycles)
+{
+  setExit(pc, cycles);
+  op(WASM_BR);
+  code.u32(nesting);
+}
+
+/**
+ * Get the host pointer of the bus page of LOCAL_ADDRESS into LOCAL_POINTER. If the page is
+ * served by a handler, leave the block so that the interpreter runs the instruction at
+ * `pc`. Nothing may have changed the registers before this within the instruction.
+ */
+static void pagePointer(bool write, uint16_t pc, int cycles)
+{
+  setExit(pc, cycles);
+  get(LOCAL_ADDRESS);
+  constant(PAGE_SHIFT);
+  op(WASM_I32_SHR_U);
+  constant(layout.pageStride);
+  op(WASM_I32_MUL);
+  memory(WASM_I32_LOAD, layout.pages + (write ? layout.pageWrite : layout.pageRead));
+  tee(LOCAL_POINTER);
+  op(WASM_I32_EQZ);
+  op(WASM_BR_IF);
+  code.u32(nesting);
+}
+
+// Push the host address of LOCAL_ADDRESS, after pagePointer().
+static void hostAddress()
+{
+  get(LOCAL_POINTER);
+  get(LOCAL_ADDRESS);
+  constant(PAGE_MASK);
+  op(WASM_I32_AND);
+  op(WASM_I32_ADD);
+}
+
+// Push the byte at LOCAL_ADDRESS.
+static void readByte(uint16_t pc, int cycles)
+{
+  pagePointer(false, pc, cycles);
+  hostAddress();
+  memory(WASM_I32_LOAD8_U, 0);
+}
+
+// Read the word at the zero-page address in LOCAL_ADDRESS into LOCAL_TEMP, wrapping within
+// page zero.
+static void readPointer(uint16_t pc, int cycles)
+{
+  readByte(pc, cycles);
+  set(LOCAL_TEMP);
+  get(LOCAL_ADDRESS);
+  constant(1);
+  op(WASM_I32_ADD);
+  setByte(LOCAL_ADDRESS);
+  readByte(pc, cycles);
+  constant(8);
+  op(WASM_I32_SHL);
+  get(LOCAL_TEMP);
+  op(WASM_I32_OR);
+  set(LOCAL_TEMP);
+}
+
+// LOCAL_PENALTY = 1 if adding `index` to the low byte of the base on the stack carries.
+static void penaltyFrom(Local index)
+{
+  constant(0xFF);
+  op(WASM_I32_AND);
+  get(index);
+  op(WASM_I32_ADD);
+  constant(8);
+  op(WASM_I32_SHR_U);
+  set(LOCAL_PENALTY);
+}
+
+// Whether the static address of a zero-page or absolute operand is on a page that the
+// generated code can access directly (for stores, that it can write).
+static bool directPage(uint16_t address, bool write)
+{
+  const BusPage &page = busPages[(address & ADDRESS_MASK) >> PAGE_SHIFT];
+  return write ? page.write != nullptr : page.read != nullptr;
+}
+
+// ----- Instruction Translation -----
+
+enum class Step
+{
+  Continue, // Translated; the block goes on with the next instruction
+  End,      // Translated a control transfer, which exits the block
+  Reject,   // Not translatable; the block ends before it
+};
+
+struct Instruction
+{
+  uint16_t pc;
+  Op op;
+  Mode mode;
+  uint16_t operand; // Operand bytes, little-endian
+  int length;
+};
+
+constexpr bool isBranch(Op op)
+{
+  return op == Op::BPL || op == Op::BMI || op == Op::BVC || op == Op::BVS || op == Op::BCC || op == Op::BCS ||
+         op == Op::BNE || op == Op::BEQ;
+}
+
+constexpr bool isReadOp(Op op)
+{
+  return op == Op::LDA || op == Op::LDX || op == Op::LDY || op == Op::AND || op == Op::ORA || op == Op::EOR ||
+         op == Op::ADC || op == Op::SBC || op == Op::CMP || op == Op::CPX || op == Op::CPY || op == Op::BIT ||
+         op == Op::LAX;
+}
+
+constexpr bool isModifyOp(Op op)
+{
+  return op == Op::ASL || op == Op::LSR || op == Op::ROL || op == Op::ROR || op == Op::INC || op == Op::DEC;
+}
+
+constexpr int operandLength(Mode mode)
+{
+  switch (mode)
+  {
+  case Mode::Implied:
+  case Mode::Accumulator:
+    return 0;
+  case Mode::Absolute:
+  case Mode::AbsoluteX:
+  case Mode::AbsoluteY:
+  case Mode::Indirect:
+    return 2;
+  default:
+    return 1;
+  }
+}
+
+/**
+ * Compute the operand address of a memory instruction into LOCAL_ADDRESS (a 13-bit bus
+ * address), and the page-crossing penalty of indexed reads into LOCAL_PENALTY.
+ *
+ * @return false if the operand is on a handler page known at translation time.
+ */
+static bool operandAddress(const Instruction &in, bool write, int cycles)
+{
+  bool penalty = hasPageCrossPenalty(in.op) && !write;
+  switch (in.mode)
+  {
+  case Mode::ZeroPage:
+  case Mode::Absolute:
+    if (!directPage(in.operand, write) || (isReadModifyWrite(in.op) && !directPage(in.operand, true)))
+      return false;
+    constant(in.operand & ADDRESS_MASK);
+    set(LOCAL_ADDRESS);
+    return true;
+  case Mode::ZeroPageX:
+  case Mode::ZeroPageY:
+    get(in.mode == Mode::ZeroPageX ? LOCAL_X : LOCAL_Y);
+    constant(in.operand);
+    op(WASM_I32_ADD);
+    setByte(LOCAL_ADDRESS);
+    return true;
+  case Mode::AbsoluteX:
+  case Mode::AbsoluteY:
+  {
+    Local index = in.mode == Mode::AbsoluteX ? LOCAL_X : LOCAL_Y;
+    if (penalty)
+    {
+      constant(in.operand);
+      penaltyFrom(index);
+    }
+    constant(in.operand);
+    get(index);
+    op(WASM_I32_ADD);
+    constant(ADDRESS_MASK);
+    op(WASM_I32_AND);
+    set(LOCAL_ADDRESS);
+    return true;
+  }
+  case Mode::IndirectX:
+  case Mode::IndirectY:
+    if (in.mode == Mode::IndirectX)
+    {
+      get(LOCAL_X);
+      constant(in.operand);
+      op(WASM_I32_ADD);
+      setByte(LOCAL_ADDRESS);
+    }
+    else
+    {
+      constant(in.operand);
+      set(LOCAL_ADDRESS);
+    }
+    readPointer(in.pc, cycles);
+    if (in.mode == Mode::IndirectY)
+    {
+      if (penalty)
+      {
+        get(LOCAL_TEMP);
+        penaltyFrom(LOCAL_Y);
+      }
+      get(LOCAL_TEMP);
+      get(LOCAL_Y);
+      op(WASM_I32_ADD);
+    }
+    else
+      get(LOCAL_TEMP);
+    constant(ADDRESS_MASK);
+    op(WASM_I32_AND);
+    set(LOCAL_ADDRESS);
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Binary ADC of LOCAL_VALUE, as addWithCarry().
+static void addWithCarry()
+{
+  get(LOCAL_A);
+  get(LOCAL_VALUE);
+  op(WASM_I32_ADD);
+  get(LOCAL_P);
+  constant(FLAG_C);
+  op(WASM_I32_AND);
+  op(WASM_I32_ADD);
+  set(LOCAL_TEMP);
+
+  // V is bit 7 of (A ^ sum) & ~(A ^ value), moved to bit 6; C is bit 8 of the sum.
+  get(LOCAL_A);
+  get(LOCAL_TEMP);
+  op(WASM_I32_XOR);
+  get(LOCAL_A);
+  get(LOCAL_VALUE);
+  op(WASM_I32_XOR);
+  constant(-1);
+  op(WASM_I32_XOR);
+  op(WASM_I32_AND);
+  constant(0x80);
+  op(WASM_I32_AND);
+  constant(1);
+  op(WASM_I32_SHR_U);
+  get(LOCAL_TEMP);
+  constant(8);
+  op(WASM_I32_SHR_U);
+  op(WASM_I32_OR);
+  setFlags(FLAG_V | FLAG_C);
+
+  get(LOCAL_TEMP);
+  setByte(LOCAL_A);
+  setNZ(LOCAL_A);
+}
+
+static void compare(Local reg)
+{
+  get(reg);
+  get(LOCAL_VALUE);
+  op(WASM_I32_GE_U);
+  setFlags(FLAG_C);
+  get(reg);
+  get(LOCAL_VALUE);
+  op(WASM_I32_SUB);
+  setByte(LOCAL_Z);
+  get(LOCAL_Z);
+  set(LOCAL_N);
+}
+
+// The operation of a read instruction on LOCAL_VALUE.
+static void readOperation(Op operation)
+{
+  switch (operation)
+  {
+  case Op::LDA:
+  case Op::LDX:
+  case Op::LDY:
+  case Op::LAX:
+  {
+    Local target = operation == Op::LDX ? LOCAL_X : operation == Op::LDY ? LOCAL_Y : LOCAL_A;
+    get(LOCAL_VALUE);
+    set(target);
+    if (operation == Op::LAX)
+    {
+      get(LOCAL_VALUE);
+      set(LOCAL_X);
+    }
+    setNZ(LOCAL_VALUE);
+    break;
+  }
+  case Op::AND:
+  case Op::ORA:
+  case Op::EOR:
+    get(LOCAL_A);
+    get(LOCAL_VALUE);
+    op(operation == Op::AND ? WASM_I32_AND : operation == Op::ORA ? WASM_I32_OR : WASM_I32_XOR);
+    set(LOCAL_A);
+    setNZ(LOCAL_A);
+    break;
+  case Op::ADC:
+    addWithCarry();
+    break;
+  case Op::SBC:
+    get(LOCAL_VALUE);
+    constant(0xFF);
+    op(WASM_I32_XOR);
+    set(LOCAL_VALUE);
+    addWithCarry();
+    break;
+  case Op::CMP:
+    compare(LOCAL_A);
+    break;
+  case Op::CPX:
+    compare(LOCAL_X);
+    break;
+  case Op::CPY:
+    compare(LOCAL_Y);
+    break;
+  case Op::BIT:
+    get(LOCAL_A);
+    get(LOCAL_VALUE);
+    op(WASM_I32_AND);
+    set(LOCAL_Z);
+    get(LOCAL_VALUE);
+    set(LOCAL_N);
+    get(LOCAL_VALUE);
+    constant(FLAG_V);
+    op(WASM_I32_AND);
+    setFlags(FLAG_V);
+    break;
+  default:
+    break;
+  }
+}
+
+// The operation of a shift, rotate, increment or decrement on LOCAL_VALUE, as modifyOp().
+static void modifyOperation(Op operation)
+{
+  switch (operation)
+  {
+  case Op::ASL:
+  case Op::ROL:
+    get(LOCAL_VALUE);
+    constant(1);
+    op(WASM_I32_SHL);
+    if (operation == Op::ROL)
+    {
+      get(LOCAL_P);
+      constant(FLAG_C);
+      op(WASM_I32_AND);
+      op(WASM_I32_OR);
+    }
+    setByte(LOCAL_TEMP);
+    get(LOCAL_VALUE);
+    constant(7);
+    op(WASM_I32_SHR_U);
+    setFlags(FLAG_C);
+    break;
+  case Op::LSR:
+  case Op::ROR:
+    get(LOCAL_VALUE);
+    constant(1);
+    op(WASM_I32_SHR_U);
+    if (operation == Op::ROR)
+    {
+      get(LOCAL_P);
+      constant(FLAG_C);
+      op(WASM_I32_AND);
+      constant(7);
+      op(WASM_I32_SHL);
+      op(WASM_I32_OR);
+    }
+    set(LOCAL_TEMP);
+    get(LOCAL_VALUE);
+    constant(FLAG_C);
+    op(WASM_I32_AND);
+    setFlags(FLAG_C);
+    break;
+  default: // INC, DEC
+    get(LOCAL_VALUE);
+    constant(operation == Op::INC ? 1 : -1);
+    op(WASM_I32_ADD);
+    setByte(LOCAL_TEMP);
+    break;
+  }
+  get(LOCAL_TEMP);
+  set(LOCAL_VALUE);
+  setNZ(LOCAL_VALUE);
+}
+
+// LOCAL_ADDRESS = $100 + ((SP + delta) & $FF).
+static void stackAddress(int delta)
+{
+  get(LOCAL_SP);
+  constant(delta);
+  op(WASM_I32_ADD);
+  constant(0xFF);
+  op(WASM_I32_AND);
+  constant(0x100);
+  op(WASM_I32_OR);
+  set(LOCAL_ADDRESS);
+}
+
+static void adjustSP(int delta)
+{
+  get(LOCAL_SP);
+  constant(delta);
+  op(WASM_I32_ADD);
+  setByte(LOCAL_SP);
+}
+
+// Push the processor status with N and Z built from their sources, as cpuStatus() | B | U.
+static void packedStatus()
+{
+  get(LOCAL_P);
+  constant(~(FLAG_N | FLAG_Z) & 0xFF);
+  op(WASM_I32_AND);
+  get(LOCAL_Z);
+  op(WASM_I32_EQZ);
+  constant(1);
+  op(WASM_I32_SHL);
+  op(WASM_I32_OR);
+  get(LOCAL_N);
+  constant(FLAG_N);
+  op(WASM_I32_AND);
+  op(WASM_I32_OR);
+  constant(FLAG_B | FLAG_U);
+  op(WASM_I32_OR);
+}
+
+static Step translateImplied(const Instruction &in, int cycles)
+{
+  static const struct
+  {
+    Op op;
+    uint8_t flag;
+    bool on;
+  } FLAG_OPS[] = {
+      {Op::CLC, FLAG_C, false}, {Op::SEC, FLAG_C, true}, {Op::CLI, FLAG_I, false}, {Op::SEI, FLAG_I, true},
+      {Op::CLD, FLAG_D, false}, {Op::SED, FLAG_D, true}, {Op::CLV, FLAG_V, false},
+  };
+  for (const auto &flagOp : FLAG_OPS)
+  {
+    if (flagOp.op == in.op)
+    {
+      constant(flagOp.on ? flagOp.flag : 0);
+      setFlags(flagOp.flag);
+      return Step::Continue;
+    }
+  }
+
+  static const struct
+  {
+    Op op;
+    Local from;
+    Local to;
+    int delta; // Added to the register (INX etc.); transfers add 0
+  } REGISTER_OPS[] = {
+      {Op::TAX, LOCAL_A, LOCAL_X, 0},  {Op::TAY, LOCAL_A, LOCAL_Y, 0},  {Op::TXA, LOCAL_X, LOCAL_A, 0},
+      {Op::TYA, LOCAL_Y, LOCAL_A, 0},  {Op::TSX, LOCAL_SP, LOCAL_X, 0}, {Op::INX, LOCAL_X, LOCAL_X, 1},
+      {Op::INY, LOCAL_Y, LOCAL_Y, 1},  {Op::DEX, LOCAL_X, LOCAL_X, -1}, {Op::DEY, LOCAL_Y, LOCAL_Y, -1},
+  };
+  for (const auto &registerOp : REGISTER_OPS)
+  {
+    if (registerOp.op == in.op)
+    {
+      get(registerOp.from);
+      if (registerOp.delta)
+      {
+        constant(registerOp.delta);
+        op(WASM_I32_ADD);
+      }
+      setByte(registerOp.to);
+      setNZ(registerOp.to);
+      return Step::Continue;
+    }
+  }
+
+  switch (in.op)
+  {
+  case Op::TXS:
+    get(LOCAL_X);
+    set(LOCAL_SP);
+    return Step::Continue;
+  case Op::NOP:
+    return Step::Continue;
+  case Op::PHA:
+  case Op::PHP:
+    stackAddress(0);
+    pagePointer(true, in.pc, cycles);
+    hostAddress();
+    if (in.op == Op::PHA)
+      get(LOCAL_A);
+    else
+      packedStatus();
+    memory(WASM_I32_STORE8, 0);
+    adjustSP(-1);
+    return Step::Continue;
+  case Op::PLA:
+  case Op::PLP:
+    stackAddress(1);
+    readByte(in.pc, cycles);
+    set(LOCAL_VALUE);
+    adjustSP(1);
+    if (in.op == Op::PLA)
+    {
+      get(LOCAL_VALUE);
+      set(LOCAL_A);
+      setNZ(LOCAL_A);
+    }
+    else
+    {
+      // As cpuSetStatus((value & ~B) | U).
+      get(LOCAL_VALUE);
+      constant(~FLAG_B & 0xFF);
+      op(WASM_I32_AND);
+      constant(FLAG_U);
+      op(WASM_I32_OR);
+      set(LOCAL_P);
+      get(LOCAL_VALUE);
+      constant(FLAG_Z);
+      op(WASM_I32_AND);
+      op(WASM_I32_EQZ);
+      set(LOCAL_Z);
+      get(LOCAL_VALUE);
+      constant(FLAG_N);
+      op(WASM_I32_AND);
+      set(LOCAL_N);
+    }
+    return Step::Continue;
+  case Op::RTS:
+  {
+    // Both stack bytes are checked before SP changes.
+    stackAddress(1);
+    readByte(in.pc, cycles);
+    set(LOCAL_VALUE);
+    stackAddress(2);
+    readByte(in.pc, cycles);
+    constant(8);
+    op(WASM_I32_SHL);
+    get(LOCAL_VALUE);
+    op(WASM_I32_OR);
+    constant(1);
+    op(WASM_I32_ADD);
+    constant(0xFFFF);
+    op(WASM_I32_AND);
+    set(LOCAL_EXIT_PC);
+    adjustSP(2);
+    constant(cycles + OPCODES[0x60].cycles);
+    set(LOCAL_EXIT_CYCLES);
+    op(WASM_BR);
+    code.u32(nesting);
+    return Step::End;
+  }
+  default:
+    return Step::Reject;
+  }
+}
+
+static Step translateBranch(const Instruction &in, int cycles)
+{
+  uint16_t next = in.pc + 2;
+  uint16_t target = next + static_cast<int8_t>(in.operand);
+  int base = cycles + 2;
+  int taken = base + 1 + (((next ^ target) & 0xFF00) != 0);
+
+  switch (in.op)
+  {
+  case Op::BPL:
+  case Op::BMI:
+    get(LOCAL_N);
+    constant(FLAG_N);
+    op(WASM_I32_AND);
+    break;
+  case Op::BVC:
+  case Op::BVS:
+    get(LOCAL_P);
+    constant(FLAG_V);
+    op(WASM_I32_AND);
+    break;
+  case Op::BCC:
+  case Op::BCS:
+    get(LOCAL_P);
+    constant(FLAG_C);
+    op(WASM_I32_AND);
+    break;
+  default: // BNE, BEQ: Z is set when zResult is 0
+    get(LOCAL_Z);
+    op(WASM_I32_EQZ);
+    break;
+  }
+  // The condition on the stack is true for BMI, BVS, BCS and BEQ.
+  bool whenSet = in.op == Op::BMI || in.op == Op::BVS || in.op == Op::BCS || in.op == Op::BEQ;
+  if (!whenSet)
+    op(WASM_I32_EQZ);
+
+  op(WASM_IF);
+  op(WASM_VOID);
+  nesting++;
+  exitTo(target, taken);
+  nesting--;
+  op(WASM_END);
+  exitTo(next, base);
+  return Step::End;
+}
+
+static Step translateInstruction(const Instruction &in, int cycles)
+{
+  if (isBranch(in.op))
+    return translateBranch(in, cycles);
+  int after = cycles + OPCODES[cartPeek(in.pc)].cycles;
+
+  switch (in.mode)
+  {
+  case Mode::Implied:
+    return translateImplied(in, cycles);
+  case Mode::Accumulator:
+    if (!isModifyOp(in.op))
+      return Step::Reject;
+    get(LOCAL_A);
+    set(LOCAL_VALUE);
+    modifyOperation(in.op);
+    get(LOCAL_VALUE);
+    set(LOCAL_A);
+    return Step::Continue;
+  case Mode::Immediate:
+    if (!isReadOp(in.op) || in.op == Op::LAX)
+      return Step::Reject;
+    if (in.op == Op::ADC || in.op == Op::SBC)
+    {
+      // Decimal mode is left to the interpreter.
+      setExit(in.pc, cycles);
+      get(LOCAL_P);
+      constant(FLAG_D);
+      op(WASM_I32_AND);
+      op(WASM_BR_IF);
+      code.u32(nesting);
+    }
+    constant(in.operand & 0xFF);
+    set(LOCAL_VALUE);
+    readOperation(in.op);
+    return Step::Continue;
+  default:
+    break;
+  }
+
+  if (in.op == Op::JMP)
+  {
+    if (in.mode != Mode::Absolute)
+      return Step::Reject;
+    exitTo(in.operand, after);
+    return Step::End;
+  }
+  if (in.op == Op::JSR)
+  {
+    // Check both stack slots before writing either.
+    stackAddress(0);
+    pagePointer(true, in.pc, cycles);
+    hostAddress();
+    set(LOCAL_HOST);
+    stackAddress(-1);
+    pagePointer(true, in.pc, cycles);
+    uint16_t returnAddress = in.pc + 2;
+    get(LOCAL_HOST);
+    constant(returnAddress >> 8);
+    memory(WASM_I32_STORE8, 0);
+    hostAddress();
+    constant(returnAddress & 0xFF);
+    memory(WASM_I32_STORE8, 0);
+    adjustSP(-2);
+    exitTo(in.operand, after);
+    return Step::End;
+  }
+
+  bool store = isStore(in.op);
+  if (!store && !isReadOp(in.op) && !isModifyOp(in.op))
+    return Step::Reject;
+
+  if (!operandAddress(in, store, cycles))
+    return Step::Reject;
+
+  if (store)
+  {
+    pagePointer(true, in.pc, cycles);
+    hostAddress();
+    if (in.op == Op::SAX)
+    {
+      get(LOCAL_A);
+      get(LOCAL_X);
+      op(WASM_I32_AND);
+    }
+    else
+      get(in.op == Op::STA ? LOCAL_A : in.op == Op::STX ? LOCAL_X : LOCAL_Y);
+    memory(WASM_I32_STORE8, 0);
+    return Step::Continue;
+  }
+
+  if ((in.op == Op::ADC || in.op == Op::SBC))
+  {
+    setExit(in.pc, cycles);
+    get(LOCAL_P);
+    constant(FLAG_D);
+    op(WASM_I32_AND);
+    op(WASM_BR_IF);
+    code.u32(nesting);
+  }
+  readByte(in.pc, cycles);
+  set(LOCAL_VALUE);
+
+  if (isModifyOp(in.op))
+  {
+    // The same page must also be writable; the dummy write of the old value only matters
+    // for handlers.
+    pagePointer(true, in.pc, cycles);
+    modifyOperation(in.op);
+    hostAddress();
+    get(LOCAL_VALUE);
+    memory(WASM_I32_STORE8, 0);
+    return Step::Continue;
+  }
+
+  readOperation(in.op);
+  if (hasPageCrossPenalty(in.op) &&
+      (in.mode == Mode::AbsoluteX || in.mode == Mode::AbsoluteY || in.mode == Mode::IndirectY))
+  {
+    get(LOCAL_EXTRA_CYCLES);
+    get(LOCAL_PENALTY);
+    op(WASM_I32_ADD);
+    set(LOCAL_EXTRA_CYCLES);
+  }
+  return Step::Continue;
+}
+
+// Whether the `length` bytes at `address` are ROM in the bank slot the block starts in. A
+// block is cached under the ROM offset of its start, so all its bytes must come from that
+// slot: the bank in the next slot can be switched without the cache knowing.
+static bool sameSlot(uint16_t start, uint16_t address, int length)
+{
+  for (int i = 0; i < length; i++)
+  {
+    uint16_t byteAddress = address + i;
+    if (((byteAddress ^ start) & 0xF000) || cartRomOffset(byteAddress) < 0 ||
+        (byteAddress & 0x0FFF) / cart.sliceSize != (start & 0x0FFF) / cart.sliceSize)
+      return false;
+  }
+  return true;
+}
+
+/**
+ * Translate the block starting at `start` into `module`.
+ *
+ * @param maxCycles Receives the cycles of the longest path through the block.
+ * @return false if the first instruction cannot be translated.
+ */
+static bool translateBlock(uint16_t start, uint16_t &maxCycles)
+{
+  code.size = 0;
+  nesting = 0;
+
+  // Locals, then the registers.
+  code.u32(1);
+  code.u32(LOCAL_COUNT);
+  code.byte(WASM_TYPE_I32);
+  loadField(LOCAL_A, layout.A);
+  loadField(LOCAL_X, layout.X);
+  loadField(LOCAL_Y, layout.Y);
+  loadField(LOCAL_SP, layout.SP);
+  loadField(LOCAL_P, layout.status);
+  loadField(LOCAL_Z, layout.zResult);
+  loadField(LOCAL_N, layout.nResult);
+
+  op(WASM_BLOCK);
+  op(WASM_VOID);
+  int cycles = 0;
+  int penalties = 0; // Instructions so far that may take a page-crossing cycle
+  int worst = 0;
+  int count = 0;
+  uint16_t pc = start;
+  for (;;)
+  {
+    Instruction in;
+    in.pc = pc;
+    uint8_t opcode = cartPeek(pc);
+    in.op = OPCODES[opcode].op;
+    in.mode = OPCODES[opcode].mode;
+    in.length = 1 + operandLength(in.mode);
+    in.operand = 0;
+    if (count == MAX_BLOCK_INSTRUCTIONS || code.size > MAX_CODE_SIZE ||
+        !sameSlot(start, pc, in.length))
+    {
+      exitTo(pc, cycles);
+      break;
+    }
+    if (in.length > 1)
+      in.operand = cartPeek(pc + 1);
+    if (in.length > 2)
+      in.operand |= cartPeek(pc + 2) << 8;
+
+    int mark = code.size;
+    Step step = translateInstruction(in, cycles);
+    if (step == Step::Reject)
+    {
+      code.size = mark;
+      exitTo(pc, cycles);
+      break;
+    }
+
+    count++;
+    int base = OPCODES[opcode].cycles;
+    if (isBranch(in.op))
+      worst = cycles + penalties + base + 2;
+    else
+    {
+      penalties += hasPageCrossPenalty(in.op) &&
+                   (in.mode == Mode::AbsoluteX || in.mode == Mode::AbsoluteY || in.mode == Mode::IndirectY);
+      worst = cycles + penalties + base;
+    }
+    cycles += base;
+    if (step == Step::End)
+      break;
+    pc += in.length;
+  }
+  op(WASM_END);
+  if (count == 0)
+    return false;
+
+  // Store the registers back and account for the cycles.
+  storeField(LOCAL_A, layout.A);
+  storeField(LOCAL_X, layout.X);
+  storeField(LOCAL_Y, layout.Y);
+  storeField(LOCAL_SP, layout.SP);
+  storeField(LOCAL_P, layout.status);
+  storeField(LOCAL_Z, layout.zResult);
+  storeField(LOCAL_N, layout.nResult);
+  constant(0);
+  get(LOCAL_EXIT_PC);
+  memory(WASM_I32_STORE16, layout.pc);
+  constant(0);
+  constant(0);
+  memory(WASM_I64_LOAD, layout.cycles);
+  get(LOCAL_EXIT_CYCLES);
+  get(LOCAL_EXTRA_CYCLES);
+  op(WASM_I32_ADD);
+  op(WASM_I64_EXTEND_I32_U);
+  op(WASM_I64_ADD);
+  memory(WASM_I64_STORE, layout.cycles);
+  op(WASM_END);
+
+  // The module: one function of type [] -> [], importing the memory and exported as "run".
+  static const uint8_t HEADER[] = {0x00, 0x61, 0x73, 0x6D, 0x01, 0x00, 0x00, 0x00};
+  static const uint8_t TYPES[] = {0x01, 0x04, 0x01, 0x60, 0x00, 0x00};
+  static const uint8_t FUNCTIONS[] = {0x03, 0x02, 0x01, 0x00};
+  static const uint8_t EXPORTS[] = {0x07, 0x07, 0x01, 0x03, 'r', 'u', 'n', 0x00, 0x00};
+  module.size = 0;
+  for (uint8_t b : HEADER)
+    module.byte(b);
+  for (uint8_t b : TYPES)
+    module.byte(b);
+
+  // Import section: "env" "memory", a memory of at least one page. A shared memory must
+  // be imported as shared, with a maximum.
+  int importSize = 1 + 4 + 7 + 1 + (layout.sharedMemory ? 1 + 1 + 5 : 1 + 1);
+  module.byte(0x02);
+  module.u32(importSize);
+  module.u32(1);
+  module.name("env");
+  module.name("memory");
+  module.byte(0x02);
+  if (layout.sharedMemory)
+  {
+    module.byte(0x03);
+    module.u32(1);
+    module.byte(0x80); // 65536 pages, padded to 5 bytes to keep importSize fixed
+    module.byte(0x80);
+    module.byte(0x84);
+    module.byte(0x80);
+    module.byte(0x00);
+  }
+  else
+  {
+    module.byte(0x00);
+    module.u32(1);
+  }
+  for (uint8_t b : FUNCTIONS)
+    module.byte(b);
+  for (uint8_t b : EXPORTS)
+    module.byte(b);
+
+  // Code section: one body.
+  CodeBuffer size;
+  size.size = 0;
+  size.u32(code.size);
+  module.byte(0x0A);
+  module.u32(1 + size.size + code.size);
+  module.u32(1);
+  module.append(size);
+  module.append(code);
+
+  maxCycles = static_cast<uint16_t>(worst);
+  return module.size <= MAX_MODULE_SIZE;
+}
+
+// Translate and load the block at `start`. Returns its index, or NO_BLOCK.
+static uint16_t compileBlock(uint16_t start)
+{
+  if (blockCount == MAX_BLOCKS)
+    return NO_BLOCK;
+  uint16_t maxCycles;
+  if (!translateBlock(start, maxCycles))
+    return NO_BLOCK;
+  int function = installBlock(module.bytes, module.size);
+  if (!function)
+    return NO_BLOCK;
+
+  Block &block = blocks[blockCount];
+  block.run = reinterpret_cast<BlockFunction>(static_cast<uintptr_t>(function));
+  block.start = start;
+  block.maxCycles = maxCycles;
+  return blockCount++;
+}
+
+void recompilerReset()
+{
+  for (int i = 1; i < blockCount; i++)
+    releaseBlock(static_cast<int>(reinterpret_cast<uintptr_t>(blocks[i].run)));
+  blockCount = 1;
+  memset(blockAt, 0, sizeof(blockAt));
+  memset(heat, 0, sizeof(heat));
+  computeLayout();
+}
+
+bool recompilerRun()
+{
+  // After an FE stack access the next access selects the bank, which only the
+  // interpreter's bus handlers see.
+  if (cart.fePending)
+    return false;
+
+  bool ran = false;
+  while (cpu.cycles < scheduler.nextCycle)
+  {
+    int offset = cartRomOffset(cpu.pc);
+    if (offset < 0)
+      break;
+    uint16_t index = blockAt[offset];
+    if (!index)
+    {
+      if (++heat[offset] < HOT_THRESHOLD)
+        break;
+      index = blockAt[offset] = compileBlock(cpu.pc);
+    }
+    if (index == NO_BLOCK)
+      break;
+
+    // The same ROM byte can appear at several addresses (mirrors, or an E0 slice in
+    // another slot), but a block's exits are absolute.
+    const Block &block = blocks[index];
+    if (block.start != cpu.pc || cpu.cycles + block.maxCycles > scheduler.nextCycle)
+      break;
+    block.run();
+    ran = true;
+  }
+  return ran;
+}
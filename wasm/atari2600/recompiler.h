@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+// ----- Block Recompiler -----
+// Hot basic blocks of ROM code are translated into WebAssembly functions and run in place
+// of the interpreter. A block is a straight run of instructions ending at a branch, jump
+// or subroutine call or return, or before any instruction the translator does not handle
+// (interrupts, decimal-mode arithmetic, most undocumented opcodes). Its registers live in
+// wasm locals and its cycles are summed at translation time.
+//
+// Blocks never touch the TIA or RIOT registers. An access whose bus page is served by a
+// handler leaves the block before that instruction (a "side exit") and the interpreter
+// runs it, so the peripherals see exact cycles without the translated code knowing about
+// them. A block only starts when its worst-case cycle count fits before the next scheduler
+// deadline, so no event can fall inside it.
+//
+// ROM never changes, so blocks are cached by their offset in the ROM image. Each bank has
+// its own blocks, a bank switch needs no invalidation, and the cache is only dropped when
+// a new ROM is loaded. Code running from RAM is always interpreted.
+//
+// Translation works everywhere, but loading the generated code needs the browser's
+// WebAssembly API, so the recompiler is only enabled in Emscripten builds. Trace builds
+// keep it off, since translated blocks are not traced.
+
+// Whether runUntil() runs translated blocks.
+extern bool recompilerEnabled;
+
+// Forget every block, e.g. when a new ROM is loaded.
+void recompilerReset();
+
+/**
+ * Run translated blocks from pc for as long as there are blocks for the code reached and
+ * they fit before the next scheduler deadline. Code becomes a block after it has been
+ * reached a few times.
+ *
+ * @return false if nothing ran, and the instruction at pc must be interpreted.
+ */
+bool recompilerRun();
@@ -0,0 +1,112 @@
+#include <cstring>
+
+#include "cpu6502.h"
+#include "riot.h"
+#include "scheduler.h"
+
+Riot riot;
+uint8_t joystickPins = 0xFF;
+uint8_t switchPins = 0x0B;
+uint8_t firePins = 0x03;
+
+// Prescaler shifts for TIM1T, TIM8T, TIM64T and T1024T.
+static const uint8_t TIMER_SHIFTS[4] = {0, 3, 6, 10};
+
+static void startTimer(uint8_t value, uint8_t shift, uint64_t start)
+{
+  riot.timerValue = value;
+  riot.timerShift = shift;
+  riot.timerStart = start;
+  // The count drops on the cycle after the start and then once per interval, so it
+  // passes zero value * interval + 1 cycles later.
+  riot.underflowCycle = start + (static_cast<uint64_t>(value) << shift) + 1;
+  schedule(EVENT_TIMER_UNDERFLOW, riot.underflowCycle);
+}
+
+void riotReset()
+{
+  memset(&riot, 0, sizeof(riot));
+  // The timer powers up counting down with the largest prescaler.
+  startTimer(0xFF, 10, cpu.cycles);
+}
+
+// Apply any underflow that has happened by now. Events are dispatched between
+// instructions, so an access late in an instruction can get here first.
+static void syncTimer()
+{
+  while (cpu.cycles >= riot.underflowCycle)
+  {
+    riot.timerInterrupt = true;
+    startTimer(0xFF, 0, riot.underflowCycle);
+  }
+}
+
+void riotTimerUnderflow()
+{
+  syncTimer();
+}
+
+// Current timer count.
+static uint8_t readTimer()
+{
+  uint64_t elapsed = cpu.cycles - riot.timerStart;
+  uint64_t ticks = elapsed == 0 ? 0 : ((elapsed - 1) >> riot.timerShift) + 1;
+  return static_cast<uint8_t>(riot.timerValue - ticks);
+}
+
+uint8_t riotRead(uint16_t address)
+{
+  // A2 selects the timer, otherwise A1-A0 select a port register.
+  if (address & 0x04)
+  {
+    syncTimer();
+    if (address & 0x01)
+      return riot.timerInterrupt ? 0x80 : 0x00; // TIMINT
+    // INTIM. Reading it clears the interrupt flag.
+    riot.timerInterrupt = false;
+    return readTimer();
+  }
+
+  switch (address & 0x03)
+  {
+  case 0: // SWCHA: output bits read back the output register, input bits the pins
+    return (riot.SWCHA & riot.SWACNT) | (joystickPins & ~riot.SWACNT);
+  case 1:
+    return riot.SWACNT;
+  case 2: // SWCHB
+    return (riot.SWCHB & riot.SWBCNT) | (switchPins & ~riot.SWBCNT);
+  default:
+    return riot.SWBCNT;
+  }
+}
+
+void riotWrite(uint16_t address, uint8_t value)
+{
+  if (address & 0x04)
+  {
+    // With A4 set this is a timer write, A1-A0 selecting the prescaler. Otherwise it
+    // configures PA7 edge detection, which is not emulated.
+    if (address & 0x10)
+    {
+      riot.timerInterrupt = false;
+      startTimer(value, TIMER_SHIFTS[address & 0x03], cpu.cycles);
+    }
+    return;
+  }
+
+  switch (address & 0x03)
+  {
+  case 0:
+    riot.SWCHA = value;
+    break;
+  case 1:
+    riot.SWACNT = value;
+    break;
+  case 2:
+    riot.SWCHB = value;
+    break;
+  default:
+    riot.SWBCNT = value;
+    break;
+  }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * State of the 6532 RIOT: 128 bytes of RAM, two I/O ports and the interval timer.
+ *
+ * The timer is not clocked. A write records the start value, the prescaler and the
+ * cycle, and reads work out the current count from the cycles elapsed since then. The
+ * underflow is a scheduler event, after which the timer restarts from $FF at one count
+ * per cycle.
+ */
+struct Riot
+{
+  uint8_t ram[128];
+
+  // Port output registers and data direction registers (1 = output).
+  uint8_t SWCHA;
+  uint8_t SWACNT;
+  uint8_t SWCHB;
+  uint8_t SWBCNT;
+
+  uint8_t timerValue;      // Count at timerStart
+  uint8_t timerShift;      // log2 of the prescaler: 0, 3, 6 or 10 (TIM1T, TIM8T, TIM64T, T1024T)
+  uint64_t timerStart;     // Cycle of the timer write, or of the last underflow
+  uint64_t underflowCycle; // Cycle on which the count next passes zero
+  bool timerInterrupt;     // TIMINT flag: set by an underflow, cleared by accessing the timer
+};
+
+extern Riot riot;
+
+// ----- Controller Inputs -----
+// Levels on the input pins, set by the frontend. Like the hardware they are active low.
+// They are not part of the emulated state, so restoring a snapshot keeps the current input.
+extern uint8_t joystickPins; // SWCHA: P0 right/left/down/up in bits 7-4, P1 in bits 3-0
+extern uint8_t switchPins;   // SWCHB: reset (bit 0), select (1), colour (3), difficulties (6, 7)
+extern uint8_t firePins;     // P0 fire in bit 0, P1 fire in bit 1 (read through TIA INPT4/INPT5)
+
+void riotReset();
+
+// Accesses to the I/O and timer registers. The address is the 13-bit bus address.
+uint8_t riotRead(uint16_t address);
+void riotWrite(uint16_t address, uint8_t value);
+
+// EVENT_TIMER_UNDERFLOW handler.
+void riotTimerUnderflow();
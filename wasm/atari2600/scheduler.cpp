@@ -0,0 +1,111 @@
+#include "scheduler.h"
+
+Scheduler scheduler;
+
+static const uint8_t NOT_PENDING = 0xFF;
+
+void schedulerReset()
+{
+  scheduler.count = 0;
+  for (int i = 0; i < EVENT_COUNT; i++)
+    scheduler.position[i] = NOT_PENDING;
+  scheduler.nextCycle = NO_EVENT;
+}
+
+static void place(int index, uint8_t event)
+{
+  scheduler.heap[index] = event;
+  scheduler.position[event] = index;
+}
+
+static bool earlier(int a, int b)
+{
+  return scheduler.when[scheduler.heap[a]] < scheduler.when[scheduler.heap[b]];
+}
+
+static void swapEntries(int a, int b)
+{
+  uint8_t event = scheduler.heap[a];
+  place(a, scheduler.heap[b]);
+  place(b, event);
+}
+
+static void siftUp(int index)
+{
+  while (index > 0)
+  {
+    int parent = (index - 1) / 2;
+    if (!earlier(index, parent))
+      break;
+    swapEntries(index, parent);
+    index = parent;
+  }
+}
+
+static void siftDown(int index)
+{
+  for (;;)
+  {
+    int smallest = index;
+    int left = 2 * index + 1;
+    int right = left + 1;
+    if (left < scheduler.count && earlier(left, smallest))
+      smallest = left;
+    if (right < scheduler.count && earlier(right, smallest))
+      smallest = right;
+    if (smallest == index)
+      break;
+    swapEntries(index, smallest);
+    index = smallest;
+  }
+}
+
+static void updateNextCycle()
+{
+  scheduler.nextCycle = scheduler.count ? scheduler.when[scheduler.heap[0]] : NO_EVENT;
+}
+
+void schedule(EventType event, uint64_t cycle)
+{
+  scheduler.when[event] = cycle;
+  int index = scheduler.position[event];
+  if (index == NOT_PENDING)
+  {
+    index = scheduler.count++;
+    place(index, event);
+  }
+  siftUp(index);
+  siftDown(scheduler.position[event]);
+  updateNextCycle();
+}
+
+// Remove the entry at `index`, filling the hole with the last entry.
+static void removeAt(int index)
+{
+  uint8_t event = scheduler.heap[index];
+  scheduler.position[event] = NOT_PENDING;
+  if (index != --scheduler.count)
+  {
+    uint8_t moved = scheduler.heap[scheduler.count];
+    place(index, moved);
+    siftUp(index);
+    siftDown(scheduler.position[moved]);
+  }
+  updateNextCycle();
+}
+
+void unschedule(EventType event)
+{
+  if (scheduler.position[event] != NOT_PENDING)
+    removeAt(scheduler.position[event]);
+}
+
+EventType popDueEvent(uint64_t now, uint64_t &cycle)
+{
+  if (scheduler.nextCycle > now)
+    return EVENT_COUNT;
+  EventType event = static_cast<EventType>(scheduler.heap[0]);
+  cycle = scheduler.when[event];
+  removeAt(0);
+  return event;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+// ----- Event Scheduler -----
+// Peripherals that need to act at a given CPU cycle register an event instead of being
+// polled after every instruction. The CPU runs in bursts up to the earliest deadline,
+// then the due events are dispatched. Each event type is pending at most once, so the
+// heap has a fixed capacity and never allocates.
+
+enum EventType : uint8_t
+{
+  EVENT_RUN_END,         // The cycle budget of run() is spent
+  EVENT_FRAME_TIMEOUT,   // The TIA reached MAX_SCANLINES_PER_FRAME without a VSYNC
+  EVENT_TIMER_UNDERFLOW, // The RIOT interval timer passes zero
+  EVENT_FRAME_END,       // The TIA finished a frame (raised when it happens)
+  EVENT_COUNT
+};
+
+const uint64_t NO_EVENT = UINT64_MAX;
+
+struct Scheduler
+{
+  uint64_t when[EVENT_COUNT];    // Deadline of each pending event
+  uint8_t heap[EVENT_COUNT];     // Pending events, a binary min-heap on `when`
+  uint8_t position[EVENT_COUNT]; // Index of each pending event in `heap`
+  uint8_t count;
+  uint64_t nextCycle; // Deadline of the earliest event, or NO_EVENT
+};
+
+extern Scheduler scheduler;
+
+void schedulerReset();
+
+// Schedule `event` for `cycle`, moving it if it is already pending.
+void schedule(EventType event, uint64_t cycle);
+
+void unschedule(EventType event);
+
+/**
+ * Remove the earliest event if it is due by `now`.
+ *
+ * @param now   Current CPU cycle.
+ * @param cycle Receives the cycle the event was scheduled for.
+ * @return The event, or EVENT_COUNT if none is due.
+ */
+EventType popDueEvent(uint64_t now, uint64_t &cycle);
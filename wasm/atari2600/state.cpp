@@ -0,0 +1,44 @@
+#include <cstring>
+
+#include "state.h"
+
+void stateSave(SaveState &state)
+{
+  state.magic = STATE_MAGIC;
+  state.version = STATE_VERSION;
+  state.size = sizeof(SaveState);
+  state.romHash = cart.romHash;
+  state.cpu = cpu;
+  state.riot = riot;
+  state.tia = tia;
+  state.tiaAudio = tiaAudio;
+  state.cart = cart;
+  state.scheduler = scheduler;
+}
+
+void stateLoad(const SaveState &state)
+{
+  cpu = state.cpu;
+  riot = state.riot;
+  tia = state.tia;
+  tiaAudio = state.tiaAudio;
+  cart = state.cart;
+  cartSync();
+  scheduler = state.scheduler;
+}
+
+bool stateLoadChecked(const uint8_t *data, int size)
+{
+  if (size != sizeof(SaveState))
+    return false;
+
+  // The buffer may not be aligned for SaveState.
+  static SaveState state;
+  memcpy(&state, data, sizeof(state));
+  if (state.magic != STATE_MAGIC || state.version != STATE_VERSION || state.size != sizeof(SaveState) ||
+      state.romHash != cart.romHash)
+    return false;
+
+  stateLoad(state);
+  return true;
+}
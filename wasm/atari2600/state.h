@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+
+#include "audio.h"
+#include "cart.h"
+#include "cpu6502.h"
+#include "riot.h"
+#include "scheduler.h"
+#include "tia.h"
+
+// ----- Snapshots -----
+// The whole emulated machine is a handful of fixed-size structs, so a snapshot is a plain
+// copy of them: about a kilobyte, taken or restored with a few memcpys. The ROM is not
+// included; the snapshot carries its hash and only loads into a machine running the same
+// ROM. Host-side state (the presented screen, the audio output, input, the palette choice)
+// is not part of it either.
+//
+// Snapshots are meant to be taken between frames (after runFrame()): the partly drawn
+// picture is not saved, so a frame in progress would resume over whatever is in the frame
+// buffer.
+
+// "A26S", at the start of every snapshot.
+const uint32_t STATE_MAGIC = 0x53363241;
+// Bump whenever the layout of SaveState or of any struct in it changes.
+const uint16_t STATE_VERSION = 1;
+
+struct SaveState
+{
+  uint32_t magic;
+  uint16_t version;
+  uint16_t size;    // sizeof(SaveState)
+  uint32_t romHash; // Cartridge::romHash of the ROM the snapshot was taken with
+  Cpu cpu;
+  Riot riot;
+  Tia tia;
+  TiaAudio tiaAudio;
+  Cartridge cart;
+  Scheduler scheduler;
+};
+
+static_assert(sizeof(SaveState) == 832, "SaveState layout changed: bump STATE_VERSION and update this size");
+
+// Copy the machine into `state`.
+void stateSave(SaveState &state);
+
+// Restore a snapshot taken with stateSave() in this session, without checks.
+void stateLoad(const SaveState &state);
+
+/**
+ * Restore a snapshot from outside (e.g. a saved file).
+ *
+ * @return false, with the machine unchanged, if the data is not a snapshot of this
+ *         version or was taken with a different ROM.
+ */
+bool stateLoadChecked(const uint8_t *data, int size);
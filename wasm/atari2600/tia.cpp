@@ -0,0 +1,659 @@
+#include <cstring>
+
+#include "audio.h"
+#include "cpu6502.h"
+#include "riot.h"
+#include "scheduler.h"
+#include "tia.h"
+
+Tia tia;
+uint8_t screen[SCREEN_WIDTH * SCREEN_HEIGHT];
+uint8_t frameBuffer[SCREEN_WIDTH * SCREEN_HEIGHT];
+bool renderEnabled = true;
+bool screenChanged = false;
+
+// Write register addresses.
+enum TiaRegister : uint8_t
+{
+  VSYNC = 0x00,
+  VBLANK = 0x01,
+  WSYNC = 0x02,
+  NUSIZ0 = 0x04,
+  NUSIZ1 = 0x05,
+  COLUP0 = 0x06,
+  COLUP1 = 0x07,
+  COLUPF = 0x08,
+  COLUBK = 0x09,
+  CTRLPF = 0x0A,
+  REFP0 = 0x0B,
+  REFP1 = 0x0C,
+  PF0 = 0x0D,
+  PF1 = 0x0E,
+  PF2 = 0x0F,
+  RESP0 = 0x10,
+  RESP1 = 0x11,
+  RESM0 = 0x12,
+  RESM1 = 0x13,
+  RESBL = 0x14,
+  AUDC0 = 0x15,
+  AUDC1 = 0x16,
+  AUDF0 = 0x17,
+  AUDF1 = 0x18,
+  AUDV0 = 0x19,
+  AUDV1 = 0x1A,
+  HMP0 = 0x20,
+  HMP1 = 0x21,
+  HMM0 = 0x22,
+  HMM1 = 0x23,
+  HMBL = 0x24,
+  GRP0 = 0x1B,
+  GRP1 = 0x1C,
+  ENAM0 = 0x1D,
+  ENAM1 = 0x1E,
+  ENABL = 0x1F,
+  VDELP0 = 0x25,
+  VDELP1 = 0x26,
+  VDELBL = 0x27,
+  RESMP0 = 0x28,
+  RESMP1 = 0x29,
+  HMOVE = 0x2A,
+  HMCLR = 0x2B,
+  CXCLR = 0x2C,
+};
+
+// CTRLPF bits.
+const uint8_t CTRLPF_REFLECT = 0x01;  // Right half of the playfield mirrors the left
+const uint8_t CTRLPF_SCORE = 0x02;    // Playfield takes the player colours, left P0 and right P1
+const uint8_t CTRLPF_PRIORITY = 0x04; // Playfield and ball are drawn in front of the players
+
+// Copies of a player or missile drawn for each value of NUSIZ bits 0-2, as offsets from
+// its position, and the width each player pixel is stretched to.
+const int COPY_COUNT[8] = {1, 2, 2, 3, 2, 1, 3, 1};
+const int COPY_OFFSETS[8][3] = {{0}, {0, 16}, {0, 32}, {0, 16, 32}, {0, 64}, {0}, {0, 32, 64}, {0}};
+const int PLAYER_SCALE[8] = {1, 1, 1, 1, 1, 2, 1, 4};
+
+// Collision latches: the two objects and the latch bit (see Tia::collisions).
+struct Collision
+{
+  TiaObject a;
+  TiaObject b;
+  uint16_t latch;
+};
+
+const Collision COLLISIONS[15] = {
+    {OBJECT_M0, OBJECT_P1, 1 << 1},  {OBJECT_M0, OBJECT_P0, 1 << 0},  // CXM0P
+    {OBJECT_M1, OBJECT_P0, 1 << 3},  {OBJECT_M1, OBJECT_P1, 1 << 2},  // CXM1P
+    {OBJECT_P0, OBJECT_PF, 1 << 5},  {OBJECT_P0, OBJECT_BL, 1 << 4},  // CXP0FB
+    {OBJECT_P1, OBJECT_PF, 1 << 7},  {OBJECT_P1, OBJECT_BL, 1 << 6},  // CXP1FB
+    {OBJECT_M0, OBJECT_PF, 1 << 9},  {OBJECT_M0, OBJECT_BL, 1 << 8},  // CXM0FB
+    {OBJECT_M1, OBJECT_PF, 1 << 11}, {OBJECT_M1, OBJECT_BL, 1 << 10}, // CXM1FB
+    {OBJECT_BL, OBJECT_PF, 1 << 13},                                  // CXBLPF
+    {OBJECT_P0, OBJECT_P1, 1 << 15}, {OBJECT_M0, OBJECT_M1, 1 << 14}, // CXPPMM
+};
+
+// ----- Line Masks -----
+
+// Add `width` pixels from `start` on, wrapping around the end of the line.
+static void addPixels(LineMask &mask, int start, int width)
+{
+  for (int i = 0; i < width; i++)
+  {
+    int x = (start + i) % SCREEN_WIDTH;
+    mask.bits[x >> 6] |= 1ull << (x & 63);
+  }
+}
+
+// The pixels [from, to).
+static LineMask spanMask(int from, int to)
+{
+  LineMask mask = {};
+  for (int word = 0; word < 3; word++)
+  {
+    int lo = from > word * 64 ? from : word * 64;
+    int hi = to < word * 64 + 64 ? to : word * 64 + 64;
+    if (lo < hi)
+      mask.bits[word] = (hi - lo == 64 ? ~0ull : (1ull << (hi - lo)) - 1) << (lo - word * 64);
+  }
+  return mask;
+}
+
+static LineMask operator|(const LineMask &a, const LineMask &b)
+{
+  return {{a.bits[0] | b.bits[0], a.bits[1] | b.bits[1], a.bits[2] | b.bits[2]}};
+}
+
+static LineMask operator&(const LineMask &a, const LineMask &b)
+{
+  return {{a.bits[0] & b.bits[0], a.bits[1] & b.bits[1], a.bits[2] & b.bits[2]}};
+}
+
+static bool overlap(const LineMask &a, const LineMask &b, const LineMask &span)
+{
+  return ((a.bits[0] & b.bits[0] & span.bits[0]) | (a.bits[1] & b.bits[1] & span.bits[1]) |
+          (a.bits[2] & b.bits[2] & span.bits[2])) != 0;
+}
+
+// Set the pixels of `mask` within `span` to `colour`.
+static void paint(uint8_t *line, const LineMask &mask, const LineMask &span, uint8_t colour)
+{
+  for (int word = 0; word < 3; word++)
+  {
+    uint64_t bits = mask.bits[word] & span.bits[word];
+    while (bits)
+    {
+      line[word * 64 + __builtin_ctzll(bits)] = colour;
+      bits &= bits - 1;
+    }
+  }
+}
+
+// ----- Playfield -----
+
+// Gather the 20 playfield bits of one half in left-to-right order: PF0 bits 4-7,
+// PF1 bits 7-0, then PF2 bits 0-7.
+static uint32_t playfieldBits()
+{
+  uint32_t bits = 0;
+  for (int i = 4; i < 8; i++)
+    bits = (bits << 1) | ((tia.PF0 >> i) & 1);
+  for (int i = 7; i >= 0; i--)
+    bits = (bits << 1) | ((tia.PF1 >> i) & 1);
+  for (int i = 0; i < 8; i++)
+    bits = (bits << 1) | ((tia.PF2 >> i) & 1);
+  return bits;
+}
+
+// Rebuild the colour of each playfield cell, and the playfield's mask. Each cell is one
+// playfield bit; the 20 bits of the left half are repeated or mirrored for the right half.
+static void updateCells()
+{
+  uint32_t bits = playfieldBits();
+  bool reflect = tia.CTRLPF & CTRLPF_REFLECT;
+  // Score mode has no effect when the playfield has priority.
+  bool score = (tia.CTRLPF & (CTRLPF_SCORE | CTRLPF_PRIORITY)) == CTRLPF_SCORE;
+  LineMask &mask = tia.masks[OBJECT_PF];
+  mask = {};
+  for (int i = 0; i < 40; i++)
+  {
+    int bit = i < 20 ? i : (reflect ? 39 - i : i - 20);
+    uint8_t colour = tia.COLUBK;
+    if ((bits >> (19 - bit)) & 1)
+    {
+      colour = score ? (i < 20 ? tia.COLUP0 : tia.COLUP1) : tia.COLUPF;
+      addPixels(mask, i * 4, 4);
+    }
+    tia.cellColours[i] = colour;
+  }
+  tia.cellsDirty = false;
+}
+
+// ----- Players, Missiles and Ball -----
+
+static LineMask playerMask(uint8_t graphics, uint8_t nusiz, uint8_t refp, int position)
+{
+  LineMask mask = {};
+  int size = nusiz & 0x07;
+  int scale = PLAYER_SCALE[size];
+  // Stretched players start one pixel later than normal ones.
+  int start = position + (scale > 1);
+  for (int copy = 0; copy < COPY_COUNT[size]; copy++)
+  {
+    for (int pixel = 0; pixel < 8; pixel++)
+    {
+      int bit = (refp & 0x08) ? pixel : 7 - pixel;
+      if ((graphics >> bit) & 1)
+        addPixels(mask, start + COPY_OFFSETS[size][copy] + pixel * scale, scale);
+    }
+  }
+  return mask;
+}
+
+static LineMask missileMask(bool enabled, uint8_t nusiz, int position)
+{
+  LineMask mask = {};
+  if (!enabled)
+    return mask;
+  int size = nusiz & 0x07;
+  int width = 1 << ((nusiz >> 4) & 0x03);
+  for (int copy = 0; copy < COPY_COUNT[size]; copy++)
+    addPixels(mask, position + COPY_OFFSETS[size][copy], width);
+  return mask;
+}
+
+// Rebuild the masks of the five movable objects from their registers and positions.
+static void updateObjects()
+{
+  uint8_t grp0 = (tia.VDELP0 & 0x01) ? tia.oldGRP0 : tia.GRP0;
+  uint8_t grp1 = (tia.VDELP1 & 0x01) ? tia.oldGRP1 : tia.GRP1;
+  uint8_t enabl = (tia.VDELBL & 0x01) ? tia.oldENABL : tia.ENABL;
+  tia.masks[OBJECT_P0] = playerMask(grp0, tia.NUSIZ0, tia.REFP0, tia.position[OBJECT_P0]);
+  tia.masks[OBJECT_P1] = playerMask(grp1, tia.NUSIZ1, tia.REFP1, tia.position[OBJECT_P1]);
+  tia.masks[OBJECT_M0] = missileMask((tia.ENAM0 & 0x02) && !(tia.RESMP0 & 0x02), tia.NUSIZ0, tia.position[OBJECT_M0]);
+  tia.masks[OBJECT_M1] = missileMask((tia.ENAM1 & 0x02) && !(tia.RESMP1 & 0x02), tia.NUSIZ1, tia.position[OBJECT_M1]);
+
+  LineMask &ball = tia.masks[OBJECT_BL];
+  ball = {};
+  if (enabl & 0x02)
+    addPixels(ball, tia.position[OBJECT_BL], 1 << ((tia.CTRLPF >> 4) & 0x03));
+  tia.objectsDirty = false;
+}
+
+// While RESMPx is set the missile is hidden and kept at the centre of its player.
+static void centreMissile(TiaObject missile, TiaObject player, uint8_t nusiz)
+{
+  static const int CENTRE[8] = {3, 3, 3, 3, 3, 6, 3, 10};
+  tia.position[missile] = (tia.position[player] + CENTRE[nusiz & 0x07]) % SCREEN_WIDTH;
+}
+
+// ----- Positions -----
+
+// Colour clock within the current scanline, at which a register write takes effect.
+static int lineClock()
+{
+  return static_cast<int>(tia.renderedClock - tia.lineStartClock);
+}
+
+// End of horizontal blank on this line: the HMOVE bar extends it by 8 clocks.
+static int blankEnd()
+{
+  return HBLANK_CLOCKS + (tia.hmoveBlank ? 8 : 0);
+}
+
+/**
+ * Position of an object reset now. The object starts drawing `delay` pixels after the
+ * beam (5 for players, 4 for missiles and the ball). A reset during horizontal blank
+ * takes effect when the object starts counting again, at the end of the blank.
+ */
+static int resetPosition(int delay)
+{
+  int clock = lineClock();
+  if (clock < blankEnd())
+    clock = blankEnd() - 2;
+  return (clock - HBLANK_CLOCKS + delay) % SCREEN_WIDTH;
+}
+
+static void resetObject(TiaObject object)
+{
+  tia.position[object] = resetPosition(object == OBJECT_P0 || object == OBJECT_P1 ? 5 : 4);
+}
+
+/**
+ * HMOVE. Once strobed, the TIA sends up to 15 extra clock pulses to each object, one every
+ * 4 colour clocks, and an object with motion nibble m (-8..7) takes (m ^ 8) of them. A
+ * pulse only moves the object when it arrives while the object is otherwise stopped, i.e.
+ * during horizontal blank; pulses during the picture are lost. A strobe during horizontal
+ * blank also extends the blank by 8 clocks, delaying every object by 8 pixels, so normal
+ * motion ranges from 7 pixels left to 8 right. The pulses are counted when the strobe
+ * happens instead of being ticked through.
+ *
+ * This reproduces the late-HMOVE behaviours: a strobe during the picture moves nothing
+ * (or only by the pulses that reach the next line's blank), and one at cycle 73-74 of the
+ * previous line moves 8 pixels further left without drawing the bar.
+ */
+static void applyHmove()
+{
+  int clock = lineClock();
+  if (clock < HBLANK_CLOCKS)
+  {
+    tia.hmoveBlank = true;
+    for (uint8_t &position : tia.position)
+      position = (position + 8) % SCREEN_WIDTH;
+  }
+
+  for (int object = 0; object < OBJECT_PF; object++)
+  {
+    int pulses = (tia.motion[object] >> 4) ^ 0x08;
+    int moved = 0;
+    for (int pulse = 0; pulse < pulses; pulse++)
+    {
+      int at = clock + 4 * (pulse + 1);
+      if (at < CLOCKS_PER_SCANLINE ? at < blankEnd() : at - CLOCKS_PER_SCANLINE < HBLANK_CLOCKS)
+        moved++;
+    }
+    tia.position[object] = (tia.position[object] + SCREEN_WIDTH - moved) % SCREEN_WIDTH;
+  }
+
+  if (tia.RESMP0 & 0x02)
+    centreMissile(OBJECT_M0, OBJECT_P0, tia.NUSIZ0);
+  if (tia.RESMP1 & 0x02)
+    centreMissile(OBJECT_M1, OBJECT_P1, tia.NUSIZ1);
+}
+
+// ----- Drawing -----
+
+/**
+ * Process pixels [from, to) of the current scanline with the current register values:
+ * latch the collisions between the objects drawn there and, if the line is on screen
+ * (y is its row), draw them.
+ */
+static void renderSpan(int y, int from, int to)
+{
+  if (tia.cellsDirty)
+    updateCells();
+  if (tia.objectsDirty)
+    updateObjects();
+
+  LineMask span = spanMask(from, to);
+  for (const Collision &collision : COLLISIONS)
+    if (!(tia.collisions & collision.latch) && overlap(tia.masks[collision.a], tia.masks[collision.b], span))
+      tia.collisions |= collision.latch;
+
+  if (y < 0 || y >= SCREEN_HEIGHT)
+    return;
+  uint8_t *line = frameBuffer + y * SCREEN_WIDTH;
+  if (tia.VBLANK & 0x02)
+  {
+    memset(line + from, 0, to - from);
+    return;
+  }
+
+  // The HMOVE bar.
+  if (tia.hmoveBlank && from < 8)
+  {
+    int end = to < 8 ? to : 8;
+    memset(line + from, 0, end - from);
+    if (end == to)
+      return;
+    span = spanMask(end, to);
+    from = end;
+  }
+
+  for (int x = from; x < to;)
+  {
+    int cellEnd = (x & ~3) + 4;
+    int end = cellEnd < to ? cellEnd : to;
+    memset(line + x, tia.cellColours[x >> 2], end - x);
+    x = end;
+  }
+
+  // Objects are painted back to front over the playfield and background.
+  const LineMask *masks = tia.masks;
+  LineMask player0 = masks[OBJECT_P0] | masks[OBJECT_M0];
+  LineMask player1 = masks[OBJECT_P1] | masks[OBJECT_M1];
+  if (tia.CTRLPF & CTRLPF_PRIORITY)
+  {
+    paint(line, player1, span, tia.COLUP1);
+    paint(line, player0, span, tia.COLUP0);
+    paint(line, masks[OBJECT_BL], span, tia.COLUPF);
+    paint(line, masks[OBJECT_PF] & (player0 | player1), span, tia.COLUPF);
+  }
+  else
+  {
+    paint(line, masks[OBJECT_BL], span, tia.COLUPF);
+    paint(line, player1, span, tia.COLUP1);
+    paint(line, player0, span, tia.COLUP0);
+  }
+}
+
+// Start a new frame on the current scanline, and give it until MAX_SCANLINES_PER_FRAME
+// lines to reach its VSYNC.
+static void startFrame()
+{
+  tia.scanline = 0;
+  schedule(EVENT_FRAME_TIMEOUT, tia.lineStartClock / 3 + MAX_SCANLINES_PER_FRAME * CYCLES_PER_SCANLINE);
+}
+
+// Finish the frame being drawn and start a new one. EVENT_FRAME_END lets a caller that
+// runs frame by frame stop here.
+static void endFrame()
+{
+  tia.lastFrameScanlines = tia.scanline;
+  if (renderEnabled && memcmp(screen, frameBuffer, sizeof(screen)) != 0)
+  {
+    memcpy(screen, frameBuffer, sizeof(screen));
+    screenChanged = true;
+  }
+  schedule(EVENT_FRAME_END, cpu.cycles);
+  startFrame();
+}
+
+void tiaReset()
+{
+  memset(&tia, 0, sizeof(tia));
+  tia.cellsDirty = true;
+  tia.objectsDirty = true;
+  startFrame();
+  memset(screen, 0, sizeof(screen));
+  memset(frameBuffer, 0, sizeof(frameBuffer));
+}
+
+void tiaCatchUp(uint64_t cycle)
+{
+  uint64_t target = cycle * 3;
+  while (tia.renderedClock < target)
+  {
+    uint64_t lineEnd = tia.lineStartClock + CLOCKS_PER_SCANLINE;
+    uint64_t end = target < lineEnd ? target : lineEnd;
+
+    // Only the part of the span after horizontal blank is processed. Collisions happen on
+    // every line, but only the visible lines are drawn.
+    int from = static_cast<int>(tia.renderedClock - tia.lineStartClock) - HBLANK_CLOCKS;
+    int to = static_cast<int>(end - tia.lineStartClock) - HBLANK_CLOCKS;
+    if (from < 0)
+      from = 0;
+    if (to > from)
+      renderSpan(tia.scanline - FIRST_VISIBLE_SCANLINE, from, to);
+
+    tia.renderedClock = end;
+    if (end == lineEnd)
+    {
+      tia.lineStartClock = lineEnd;
+      tia.hmoveBlank = false;
+      if (++tia.scanline >= MAX_SCANLINES_PER_FRAME)
+        endFrame();
+    }
+  }
+}
+
+void tiaFrameTimeout(uint64_t cycle)
+{
+  // Drawing up to the deadline crosses the last scanline, which ends the frame.
+  tiaCatchUp(cycle);
+}
+
+uint8_t tiaRead(uint16_t address)
+{
+  // Only A3-A0 are decoded for reads, and only D7 (and D6) are driven.
+  uint8_t reg = address & 0x0F;
+  if (reg < 8)
+  {
+    // CXM0P to CXPPMM: the collision latches, up to date as of this cycle.
+    tiaCatchUp(cpu.cycles);
+    return ((tia.collisions >> (reg * 2)) & 0x03) << 6;
+  }
+  switch (reg)
+  {
+  case 0x0C: // INPT4: P0 fire button, low when pressed
+    return (firePins & 0x01) ? 0x80 : 0x00;
+  case 0x0D: // INPT5: P1 fire button
+    return (firePins & 0x02) ? 0x80 : 0x00;
+  default:
+    // Paddle inputs are not emulated yet.
+    return 0;
+  }
+}
+
+void tiaWrite(uint16_t address, uint8_t value)
+{
+  // The write lands on the last cycle of the instruction: draw everything up to then
+  // with the old register values.
+  tiaCatchUp(cpu.cycles);
+
+  switch (address & 0x3F)
+  {
+  case VSYNC:
+    // Turning VSYNC on starts the next frame.
+    if ((value & 0x02) && !(tia.VSYNC & 0x02))
+    {
+      tia.frameScanlines = tia.scanline;
+      endFrame();
+    }
+    tia.VSYNC = value;
+    break;
+  case VBLANK:
+    tia.VBLANK = value;
+    break;
+  case WSYNC:
+    // The CPU stops until the end of the scanline. Nothing changes on screen meanwhile,
+    // so the stalled cycles are skipped rather than stepped.
+    cpuHaltUntil(nextScanlineCycle(cpu.cycles));
+    break;
+  case COLUP0:
+    tia.COLUP0 = value;
+    tia.cellsDirty = true;
+    break;
+  case COLUP1:
+    tia.COLUP1 = value;
+    tia.cellsDirty = true;
+    break;
+  case COLUPF:
+    tia.COLUPF = value;
+    tia.cellsDirty = true;
+    break;
+  case COLUBK:
+    tia.COLUBK = value;
+    tia.cellsDirty = true;
+    break;
+  case CTRLPF:
+    tia.CTRLPF = value;
+    tia.cellsDirty = true;
+    tia.objectsDirty = true;
+    break;
+  case NUSIZ0:
+    tia.NUSIZ0 = value;
+    tia.objectsDirty = true;
+    break;
+  case NUSIZ1:
+    tia.NUSIZ1 = value;
+    tia.objectsDirty = true;
+    break;
+  case REFP0:
+    tia.REFP0 = value;
+    tia.objectsDirty = true;
+    break;
+  case REFP1:
+    tia.REFP1 = value;
+    tia.objectsDirty = true;
+    break;
+  case PF0:
+    tia.PF0 = value;
+    tia.cellsDirty = true;
+    break;
+  case PF1:
+    tia.PF1 = value;
+    tia.cellsDirty = true;
+    break;
+  case PF2:
+    tia.PF2 = value;
+    tia.cellsDirty = true;
+    break;
+  case RESP0:
+    resetObject(OBJECT_P0);
+    if (tia.RESMP0 & 0x02)
+      centreMissile(OBJECT_M0, OBJECT_P0, tia.NUSIZ0);
+    tia.objectsDirty = true;
+    break;
+  case RESP1:
+    resetObject(OBJECT_P1);
+    if (tia.RESMP1 & 0x02)
+      centreMissile(OBJECT_M1, OBJECT_P1, tia.NUSIZ1);
+    tia.objectsDirty = true;
+    break;
+  case RESM0:
+    resetObject(OBJECT_M0);
+    tia.objectsDirty = true;
+    break;
+  case RESM1:
+    resetObject(OBJECT_M1);
+    tia.objectsDirty = true;
+    break;
+  case RESBL:
+    resetObject(OBJECT_BL);
+    tia.objectsDirty = true;
+    break;
+  case AUDC0:
+  case AUDC1:
+    audioWriteControl((address & 0x3F) - AUDC0, value);
+    break;
+  case AUDF0:
+  case AUDF1:
+    audioWriteFrequency((address & 0x3F) - AUDF0, value);
+    break;
+  case AUDV0:
+  case AUDV1:
+    audioWriteVolume((address & 0x3F) - AUDV0, value);
+    break;
+  case GRP0:
+    tia.GRP0 = value;
+    tia.oldGRP1 = tia.GRP1;
+    tia.objectsDirty = true;
+    break;
+  case GRP1:
+    tia.GRP1 = value;
+    tia.oldGRP0 = tia.GRP0;
+    tia.oldENABL = tia.ENABL;
+    tia.objectsDirty = true;
+    break;
+  case ENAM0:
+    tia.ENAM0 = value;
+    tia.objectsDirty = true;
+    break;
+  case ENAM1:
+    tia.ENAM1 = value;
+    tia.objectsDirty = true;
+    break;
+  case ENABL:
+    tia.ENABL = value;
+    tia.objectsDirty = true;
+    break;
+  case VDELP0:
+    tia.VDELP0 = value;
+    tia.objectsDirty = true;
+    break;
+  case VDELP1:
+    tia.VDELP1 = value;
+    tia.objectsDirty = true;
+    break;
+  case VDELBL:
+    tia.VDELBL = value;
+    tia.objectsDirty = true;
+    break;
+  case RESMP0:
+    tia.RESMP0 = value;
+    if (value & 0x02)
+      centreMissile(OBJECT_M0, OBJECT_P0, tia.NUSIZ0);
+    tia.objectsDirty = true;
+    break;
+  case RESMP1:
+    tia.RESMP1 = value;
+    if (value & 0x02)
+      centreMissile(OBJECT_M1, OBJECT_P1, tia.NUSIZ1);
+    tia.objectsDirty = true;
+    break;
+  case HMP0:
+    tia.motion[OBJECT_P0] = value;
+    break;
+  case HMP1:
+    tia.motion[OBJECT_P1] = value;
+    break;
+  case HMM0:
+    tia.motion[OBJECT_M0] = value;
+    break;
+  case HMM1:
+    tia.motion[OBJECT_M1] = value;
+    break;
+  case HMBL:
+    tia.motion[OBJECT_BL] = value;
+    break;
+  case HMOVE:
+    applyHmove();
+    tia.objectsDirty = true;
+    break;
+  case HMCLR:
+    memset(tia.motion, 0, sizeof(tia.motion));
+    break;
+  case CXCLR:
+    tia.collisions = 0;
+    break;
+  }
+}
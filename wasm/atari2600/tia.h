@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstdint>
+
+// ----- Video Timing -----
+// The TIA draws 228 colour clocks per scanline: 68 of horizontal blank, then 160 pixels.
+// The CPU runs at a third of the colour clock, so a scanline is 76 CPU cycles.
+const int CLOCKS_PER_SCANLINE = 228;
+const int HBLANK_CLOCKS = 68;
+const int CYCLES_PER_SCANLINE = CLOCKS_PER_SCANLINE / 3;
+const int SCANLINES_PER_FRAME = 262; // NTSC
+const int CYCLES_PER_FRAME = CYCLES_PER_SCANLINE * SCANLINES_PER_FRAME;
+
+// The visible picture: 160 pixels by the 192 scanlines that follow 3 lines of VSYNC and
+// 37 lines of vertical blank.
+const int SCREEN_WIDTH = 160;
+const int SCREEN_HEIGHT = 192;
+const int FIRST_VISIBLE_SCANLINE = 40;
+// A frame ends when the program starts VSYNC. Kernels that never do still produce a
+// frame after this many scanlines.
+const int MAX_SCANLINES_PER_FRAME = 320;
+
+// ----- Objects -----
+// The playfield and the five movable objects. Each one's coverage of the line is kept as a
+// 160-bit mask, so collisions are found with a few word-wide ANDs per span.
+enum TiaObject
+{
+  OBJECT_P0, // Player 0
+  OBJECT_M0, // Missile 0
+  OBJECT_P1,
+  OBJECT_M1,
+  OBJECT_BL, // Ball
+  OBJECT_PF, // Playfield
+  OBJECT_COUNT
+};
+
+// A set of pixels across the line: pixel x is bit x % 64 of bits[x / 64].
+struct LineMask
+{
+  uint64_t bits[3];
+};
+
+/**
+ * State of the TIA video chip.
+ */
+struct Tia
+{
+  // Write-only registers that affect the picture.
+  uint8_t VSYNC;
+  uint8_t VBLANK;
+  uint8_t NUSIZ0; // Copies and size of player 0, and size of missile 0
+  uint8_t NUSIZ1;
+  uint8_t COLUP0;
+  uint8_t COLUP1;
+  uint8_t COLUPF;
+  uint8_t COLUBK;
+  uint8_t CTRLPF;
+  uint8_t REFP0; // Bit 3: draw player 0 mirrored
+  uint8_t REFP1;
+  uint8_t PF0;
+  uint8_t PF1;
+  uint8_t PF2;
+  uint8_t ENAM0;
+  uint8_t ENAM1;
+  uint8_t RESMP0; // Bit 1: hide missile 0 and keep it centred on player 0
+  uint8_t RESMP1;
+  uint8_t VDELP0; // Bit 0: draw player 0 from oldGRP0
+  uint8_t VDELP1;
+  uint8_t VDELBL;
+
+  // Player graphics and the ball enable are double-buffered for vertical delay: writing GRP0
+  // copies GRP1 to oldGRP1, and writing GRP1 copies GRP0 and ENABL to their old copies.
+  uint8_t GRP0;
+  uint8_t GRP1;
+  uint8_t ENABL;
+  uint8_t oldGRP0;
+  uint8_t oldGRP1;
+  uint8_t oldENABL;
+
+  // Horizontal motion of each movable object (HMP0, HMM0, HMP1, HMM1, HMBL), applied by
+  // HMOVE. The high nibble is signed; positive values move left.
+  uint8_t motion[OBJECT_PF];
+
+  // Pixel at which each movable object starts drawing. Positions are computed when an
+  // object is reset or moved, rather than by counting colour clocks.
+  uint8_t position[OBJECT_PF];
+  // HMOVE was strobed during this line's horizontal blank, which extends the blank over
+  // the first 8 pixels (the "HMOVE bar").
+  bool hmoveBlank;
+
+  // Collision latches, set when two objects draw the same pixel and cleared by CXCLR.
+  // Bits 2n and 2n+1 are D6 and D7 of collision register n.
+  uint16_t collisions;
+
+  // Colour of each of the 40 playfield cells (4 pixels each) across the line, derived from
+  // the registers above and rebuilt before drawing when cellsDirty is set.
+  uint8_t cellColours[40];
+  bool cellsDirty;
+  // Coverage of each object, rebuilt when objectsDirty is set (the playfield's with the cells).
+  LineMask masks[OBJECT_COUNT];
+  bool objectsDirty;
+
+  int scanline;            // Scanline within the current frame
+  int frameScanlines;      // Length of the last frame ended by VSYNC (0 until there is one)
+  int lastFrameScanlines;  // Length of the last frame, however it ended
+  uint64_t lineStartClock; // Colour clock at which the current scanline began
+  uint64_t renderedClock;  // Colour clock up to which the picture has been drawn
+};
+
+extern Tia tia;
+
+// The last complete frame, one colour register value per pixel.
+extern uint8_t screen[SCREEN_WIDTH * SCREEN_HEIGHT];
+// The frame being drawn. It is copied to `screen` when the frame ends.
+extern uint8_t frameBuffer[SCREEN_WIDTH * SCREEN_HEIGHT];
+// When false, completed frames are not copied to `screen` (used for frames that are not presented).
+extern bool renderEnabled;
+// Set when a completed frame that differs from the previous one is copied to `screen`.
+// Cleared by the caller.
+extern bool screenChanged;
+
+void tiaReset();
+
+// Register accesses from the bus. The address is the 13-bit bus address.
+uint8_t tiaRead(uint16_t address);
+void tiaWrite(uint16_t address, uint8_t value);
+
+/**
+ * Draw the picture up to the end of CPU cycle `cycle`. The TIA is rendered lazily: nothing
+ * is drawn while the CPU runs, and before a register changes the picture is brought up to
+ * date with the old register values, one span at a time.
+ */
+void tiaCatchUp(uint64_t cycle);
+
+// EVENT_FRAME_TIMEOUT handler: end a frame that has run on without a VSYNC.
+void tiaFrameTimeout(uint64_t cycle);
+
+// The first CPU cycle of the scanline after the one containing `cycle`, or `cycle` itself
+// if it starts a scanline. WSYNC halts the CPU until then.
+inline uint64_t nextScanlineCycle(uint64_t cycle)
+{
+  return (cycle + CYCLES_PER_SCANLINE - 1) / CYCLES_PER_SCANLINE * CYCLES_PER_SCANLINE;
+}
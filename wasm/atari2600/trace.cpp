@@ -0,0 +1,65 @@
+#ifdef ATARI2600_TRACE
+
+#include <algorithm>
+
+#include "cart.h"
+#include "cpu6502.h"
+#include "trace.h"
+
+static TraceRecord records[TRACE_CAPACITY];
+// Index of the next record to write, and whether the buffer has wrapped.
+static int head = 0;
+static bool full = false;
+
+// Read an instruction byte without the side effects of a bus read (e.g. bank switching).
+static uint8_t peek(uint16_t address)
+{
+  address &= ADDRESS_MASK;
+  const BusPage &page = busPages[address >> PAGE_SHIFT];
+  if (page.read)
+    return page.read[address & PAGE_MASK];
+  return (address & 0x1000) ? cartPeek(address) : 0;
+}
+
+void BufferTrace::record(uint16_t pc, uint8_t opcode)
+{
+  TraceRecord &r = records[head];
+  r.cycle = cpu.cycles;
+  r.pc = pc;
+  r.bytes[0] = opcode;
+  r.bytes[1] = peek(pc + 1);
+  r.bytes[2] = peek(pc + 2);
+  r.A = cpu.A;
+  r.X = cpu.X;
+  r.Y = cpu.Y;
+  r.P = cpuStatus();
+  r.SP = cpu.SP;
+  if (++head == TRACE_CAPACITY)
+  {
+    head = 0;
+    full = true;
+  }
+}
+
+const TraceRecord *traceRecords()
+{
+  if (full && head != 0)
+  {
+    std::rotate(records, records + head, records + TRACE_CAPACITY);
+    head = 0;
+  }
+  return records;
+}
+
+int traceLength()
+{
+  return full ? TRACE_CAPACITY : head;
+}
+
+void traceClear()
+{
+  head = 0;
+  full = false;
+}
+
+#endif
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+
+// ----- Instruction Tracing -----
+// cpuStep() is templated on a trace policy, called once per instruction before it runs.
+// NoTrace is empty, so the release build contains no tracing code at all. Building with
+// -DATARI2600_TRACE selects BufferTrace, which records every instruction into a ring
+// buffer of binary records for tools/atari2600/disassemble-trace.js to format.
+
+/**
+ * One traced instruction: the state of the CPU before it ran. The layout is read by the
+ * disassembler, so it must not change without updating the tool.
+ */
+struct TraceRecord
+{
+  uint64_t cycle; // cpu.cycles before the instruction
+  uint16_t pc;
+  uint8_t bytes[3]; // Opcode and operand bytes (the disassembler knows how many are used)
+  uint8_t A;
+  uint8_t X;
+  uint8_t Y;
+  uint8_t P;
+  uint8_t SP;
+  uint8_t reserved[6];
+};
+
+static_assert(sizeof(TraceRecord) == 24, "TraceRecord layout is read by the disassembler");
+
+// Records kept; older ones are overwritten.
+const int TRACE_CAPACITY = 1 << 16;
+
+struct NoTrace
+{
+  static void record(uint16_t pc, uint8_t opcode)
+  {
+    (void)pc;
+    (void)opcode;
+  }
+};
+
+struct BufferTrace
+{
+  static void record(uint16_t pc, uint8_t opcode);
+};
+
+#ifdef ATARI2600_TRACE
+using CpuTrace = BufferTrace;
+
+// Put the records in order, oldest first, and return them. traceLength() are valid.
+const TraceRecord *traceRecords();
+int traceLength();
+void traceClear();
+#else
+using CpuTrace = NoTrace;
+#endif
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+// Core state and helpers shared by the interpreter (main.cpp) and by ROMs translated
+// ahead of time with tools/chip8/aot-translate.js.
+
+const int SCREEN_WIDTH = 64;
+const int SCREEN_HEIGHT = 32;
+
+extern uint8_t screen[SCREEN_WIDTH * SCREEN_HEIGHT];
+extern uint8_t memory[4096];
+extern uint8_t V[16];
+extern uint16_t I;
+extern uint16_t pc;
+extern uint16_t stack[16];
+extern uint8_t sp;
+extern uint8_t delayTimer;
+extern uint8_t soundTimer;
+extern uint8_t keys[16];
+extern uint8_t audioPattern[16];
+extern bool audioPatternLoaded;
+extern uint8_t audioPitch;
+
+void cls();
+uint8_t nextRandom();
+void drawSprite(uint8_t x, uint8_t y, uint8_t height);
+void loadAudioPattern();
+
+#ifdef CHIP8_AOT
+// Implemented by the translation unit generated for one ROM.
+
+// Enable the translated code if `program` is the ROM it was generated from.
+void aotAttach(const uint8_t *program, int size);
+
+// Execute translated code from pc for up to `budget` instructions. Returns the unused
+// budget as soon as pc reaches code that was not translated, leaving it to the interpreter.
+int aotExecute(int budget);
+
+// Discard translated blocks overlapping memory[address, address + length) after a write.
+void aotInvalidate(uint16_t address, int length);
+#endif
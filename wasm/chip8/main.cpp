@@ -1,11 +1,12 @@
+#include <cmath>
 #include <cstdlib>
 #include <ctime>
 #include <cstdint>
 #include <cstring>
 #include <stdio.h>
 
-const int SCREEN_WIDTH = 64;
-const int SCREEN_HEIGHT = 32;
+#include "../common/audio_ring.h"
+#include "chip8.h"
 
 // The screen buffer holds 1-bit values for each pixel.
 uint8_t screen[SCREEN_WIDTH * SCREEN_HEIGHT];
@@ -27,6 +28,52 @@ uint8_t keys[16]; // Keypad state: 16 keys, each with a value of 0 (up) or 1 (do
 float timerAccumulator = 0.0f;                   // Accumulated time for timers
 const float TIMER_INTERVAL_MS = 1000.0f / 60.0f; // ~16.67 ms at 60Hz
 
+// Random number generator state for CXNN. Kept here rather than in std::rand() so that
+// snapshots capture it and a restored state replays the same random numbers.
+uint32_t rngState = 1;
+
+// ----- Audio -----
+// The sound output is a 1-bit waveform: a 128-bit pattern played back at a rate set by the pitch register.
+// Until a ROM loads its own pattern (XO-CHIP F002), the pattern is a 440 Hz square wave buzzer.
+const float AUDIO_VOLUME = 0.25f;
+const float BUZZER_RATE = 880.0f; // Alternating bits at 880 bits/s give a 440 Hz square wave.
+
+AudioRing audioRing;            // Shared with the AudioWorklet, which drains it.
+int audioSampleRate = 0;        // Host sample rate; 0 until initAudio() is called.
+double audioSampleAccumulator = 0.0; // Fractional samples carried between timer ticks.
+
+uint8_t audioPattern[16];       // XO-CHIP audio pattern buffer (128 bits, MSB first).
+bool audioPatternLoaded = false; // True once the ROM has executed F002.
+uint8_t audioPitch = 64;        // XO-CHIP pitch register (Fx3A); 64 = 4000 bits/s.
+double audioPhase = 0.0;        // Playback position in the pattern, in bits [0, 128).
+float audioPending = 0.0f;      // Sample held back by one so edges can be corrected on both sides.
+float audioLevel = 0.0f;        // Output level of the current bit (0 while the sound timer is off).
+
+// ----- Run-ahead -----
+// Everything needed to resume emulation exactly. Host-side state (keys, audio output) is excluded.
+struct Snapshot
+{
+  uint8_t memory[4096];
+  uint8_t screen[SCREEN_WIDTH * SCREEN_HEIGHT];
+  uint8_t V[16];
+  uint16_t I;
+  uint16_t pc;
+  uint16_t stack[16];
+  uint8_t sp;
+  uint8_t delayTimer;
+  uint8_t soundTimer;
+  float timerAccumulator;
+  uint32_t rngState;
+  uint8_t audioPattern[16];
+  bool audioPatternLoaded;
+  uint8_t audioPitch;
+};
+
+Snapshot runAheadSnapshot;
+uint8_t aheadScreen[SCREEN_WIDTH * SCREEN_HEIGHT]; // The speculative frame shown while run-ahead is active.
+bool runAheadActive = false;
+bool speculative = false; // True while emulating frames that will be rolled back; suppresses audio.
+
 // Load the built‑in Chip‑8 fontset (16 characters × 5 bytes each) at memory address 0x50
 static constexpr uint8_t FONTSET[80] = {
     0xF0, 0x90, 0x90, 0x90, 0xF0, // 0
@@ -53,6 +100,165 @@ void cls()
   memset(screen, 0, SCREEN_WIDTH * SCREEN_HEIGHT);
 }
 
+// Draw an 8-pixel-wide sprite of `height` rows from memory[I] at (x, y), XOR-ing it onto the
+// screen and wrapping at the edges. VF is set to 1 if any pixel is erased (collision), otherwise 0.
+void drawSprite(uint8_t x, uint8_t y, uint8_t height)
+{
+  uint8_t collision = 0;
+
+  for (int row = 0; row < height; row++)
+  {
+    uint8_t spriteByte = memory[I + row];
+    for (int col = 0; col < 8; col++)
+    {
+      uint8_t spritePixel = (spriteByte >> (7 - col)) & 0x1;
+      int sx = (x + col) % SCREEN_WIDTH;
+      int sy = (y + row) % SCREEN_HEIGHT;
+      // Check existing pixel before XOR
+      if (screen[sy * SCREEN_WIDTH + sx] && spritePixel)
+      {
+        collision = 1;
+      }
+      screen[sy * SCREEN_WIDTH + sx] ^= spritePixel;
+    }
+  }
+  V[0xF] = collision; // Set VF = collision flag
+}
+
+// F002: load the 16-byte audio pattern from memory[I]. I can point anywhere in its 16-bit
+// range, so the read wraps at the end of memory.
+void loadAudioPattern()
+{
+  for (int i = 0; i < static_cast<int>(sizeof(audioPattern)); i++)
+    audioPattern[i] = memory[(I + i) & 0xFFF];
+  audioPatternLoaded = true;
+}
+
+// Notify translated code (if any) that memory[address, address + length) was written,
+// so blocks translated from those bytes stop being used.
+void memoryWritten(uint16_t address, int length)
+{
+#ifdef CHIP8_AOT
+  aotInvalidate(address, length);
+#else
+  (void)address;
+  (void)length;
+#endif
+}
+
+// Return the next pseudo-random byte (xorshift32).
+uint8_t nextRandom()
+{
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return rngState & 0xFF;
+}
+
+void saveState(Snapshot &s)
+{
+  memcpy(s.memory, memory, sizeof(memory));
+  memcpy(s.screen, screen, sizeof(screen));
+  memcpy(s.V, V, sizeof(V));
+  s.I = I;
+  s.pc = pc;
+  memcpy(s.stack, stack, sizeof(stack));
+  s.sp = sp;
+  s.delayTimer = delayTimer;
+  s.soundTimer = soundTimer;
+  s.timerAccumulator = timerAccumulator;
+  s.rngState = rngState;
+  memcpy(s.audioPattern, audioPattern, sizeof(audioPattern));
+  s.audioPatternLoaded = audioPatternLoaded;
+  s.audioPitch = audioPitch;
+}
+
+void loadState(const Snapshot &s)
+{
+  memcpy(memory, s.memory, sizeof(memory));
+  memcpy(screen, s.screen, sizeof(screen));
+  memcpy(V, s.V, sizeof(V));
+  I = s.I;
+  pc = s.pc;
+  memcpy(stack, s.stack, sizeof(stack));
+  sp = s.sp;
+  delayTimer = s.delayTimer;
+  soundTimer = s.soundTimer;
+  timerAccumulator = s.timerAccumulator;
+  rngState = s.rngState;
+  memcpy(audioPattern, s.audioPattern, sizeof(audioPattern));
+  audioPatternLoaded = s.audioPatternLoaded;
+  audioPitch = s.audioPitch;
+}
+
+// Output level of bit `index` (0–127) of the audio pattern.
+float patternLevel(int index)
+{
+  return ((audioPattern[index >> 3] >> (7 - (index & 7))) & 1) ? AUDIO_VOLUME : -AUDIO_VOLUME;
+}
+
+/**
+ * Synthesise `count` samples at the host sample rate and queue them in the audio ring.
+ *
+ * The sound output is a 1-bit signal, so every bit change is a hard step that would alias.
+ * Each step is smoothed with a two-sample polynomial band-limited step (polyBLEP): the samples
+ * on either side of the edge are corrected according to where between them the edge fell.
+ * Because the sample before an edge must still be adjustable, output runs one sample behind
+ * synthesis (audioPending).
+ *
+ * @param count Number of samples to produce.
+ * @param gate  True while the sound timer is running; the output is silent otherwise.
+ */
+void renderAudio(int count, bool gate)
+{
+  double rate = audioPatternLoaded ? 4000.0 * std::pow(2.0, (audioPitch - 64) / 48.0) : BUZZER_RATE;
+  double step = rate / audioSampleRate; // Pattern bits advanced per output sample.
+  float buffer[256];
+
+  while (count > 0)
+  {
+    int chunk = count < 256 ? count : 256;
+    for (int n = 0; n < chunk; n++)
+    {
+      float correction = 0.0f;
+      // Add a step of size delta that happened u samples before the new sample (0 <= u <= 1).
+      auto addEdge = [&](float delta, float u)
+      {
+        audioPending += delta * 0.5f * u * u;
+        correction -= delta * 0.5f * (1.0f - u) * (1.0f - u);
+        audioLevel += delta;
+      };
+
+      if (gate)
+      {
+        // Sound timer just started: step from silence to the current bit.
+        if (audioLevel == 0.0f)
+          addEdge(patternLevel((int)audioPhase & 127), 1.0f);
+
+        // Visit every bit boundary crossed during this sample period.
+        double end = audioPhase + step;
+        for (double edge = std::floor(audioPhase) + 1.0; edge <= end; edge += 1.0)
+        {
+          float delta = patternLevel((int)edge & 127) - audioLevel;
+          if (delta != 0.0f)
+            addEdge(delta, (float)((end - edge) / step));
+        }
+        audioPhase = std::fmod(end, 128.0);
+      }
+      else if (audioLevel != 0.0f)
+      {
+        // Sound timer expired: step back to silence.
+        addEdge(-audioLevel, 1.0f);
+      }
+
+      buffer[n] = audioPending;
+      audioPending = audioLevel + correction;
+    }
+    audioRing.write(buffer, chunk);
+    count -= chunk;
+  }
+}
+
 extern "C"
 {
   // Load a Chip‑8 program into memory starting at 0x200.
@@ -60,18 +266,25 @@ extern "C"
   {
     memcpy(memory + 0x200, program, size);
     pc = 0x200;
+#ifdef CHIP8_AOT
+    aotAttach(program, size);
+#endif
   }
 
   // Initialize the Chip‑8 state.
   void init()
   {
-    std::srand(static_cast<unsigned int>(std::time(nullptr)));
+    rngState = static_cast<uint32_t>(std::time(nullptr)) | 1; // xorshift state must be non-zero
     cls();
     memset(V, 0, sizeof(V));
     I = 0;
     pc = 0x200;
 
     memcpy(memory + 0x50, FONTSET, sizeof(FONTSET));
+
+    memset(audioPattern, 0xAA, sizeof(audioPattern));
+    audioPatternLoaded = false;
+    audioPitch = 64;
   }
 
   /**
@@ -115,6 +328,8 @@ extern "C"
    *   - Fx33: LD B, Vx       - Store BCD representation of Vx in memory at I, I+1, and I+2.
    *   - Fx55: LD [I], V0..Vx - Store registers V0 through Vx in memory starting at I.
    *   - Fx65: LD V0..Vx, [I] - Read registers V0 through Vx from memory starting at I.
+   *   - F002: AUDIO          - (XO-CHIP) Load the 16-byte audio pattern from memory at I.
+   *   - Fx3A: PITCH Vx       - (XO-CHIP) Set the audio pattern playback pitch to Vx.
    *
    * Any unsupported opcode is logged and skipped.
    */
@@ -402,7 +617,7 @@ extern "C"
        */
       uint8_t x = (opcode & 0x0F00) >> 8;
       uint8_t nn = opcode & 0x00FF;
-      V[x] = (std::rand() % 256) & nn;
+      V[x] = nextRandom() & nn;
       pc += 2;
       break;
     }
@@ -414,28 +629,7 @@ extern "C"
        * Drawing is performed using XOR, toggling the pixels on the screen.
        * VF is set to 1 if any pixel is erased (collision), otherwise 0.
        */
-      uint8_t x = V[(opcode & 0x0F00) >> 8];
-      uint8_t y = V[(opcode & 0x00F0) >> 4];
-      uint8_t height = opcode & 0x000F;
-      uint8_t collision = 0;
-
-      for (int row = 0; row < height; row++)
-      {
-        uint8_t spriteByte = memory[I + row];
-        for (int col = 0; col < 8; col++)
-        {
-          uint8_t spritePixel = (spriteByte >> (7 - col)) & 0x1;
-          int sx = (x + col) % SCREEN_WIDTH;
-          int sy = (y + row) % SCREEN_HEIGHT;
-          // Check existing pixel before XOR
-          if (screen[sy * SCREEN_WIDTH + sx] && spritePixel)
-          {
-            collision = 1;
-          }
-          screen[sy * SCREEN_WIDTH + sx] ^= spritePixel;
-        }
-      }
-      V[0xF] = collision; // Set VF = collision flag
+      drawSprite(V[(opcode & 0x0F00) >> 8], V[(opcode & 0x00F0) >> 4], opcode & 0x000F);
       pc += 2;
       break;
     }
@@ -479,11 +673,18 @@ extern "C"
        * Fx33 - LD B, Vx    : Store the BCD representation of Vx in memory at I, I+1, and I+2.
        * Fx55 - LD [I], V0..Vx  : Store registers V0 through Vx in memory starting at I.
        * Fx65 - LD V0..Vx, [I]  : Read registers V0 through Vx from memory starting at I.
+       * F002 - AUDIO           : (XO-CHIP) Load the audio pattern buffer from memory at I.
+       * Fx3A - PITCH Vx        : (XO-CHIP) Set the audio pattern playback pitch.
        */
       uint8_t x = (opcode & 0x0F00) >> 8;
       uint8_t kk = opcode & 0x00FF;
       switch (kk)
       {
+      case 0x02:
+        // F002: AUDIO – Load the 16-byte (128-bit) audio pattern from memory at I.
+        loadAudioPattern();
+        pc += 2;
+        break;
       case 0x07:
         // Fx07: LD Vx, DT – Load delay timer into Vx.
         V[x] = delayTimer;
@@ -541,9 +742,15 @@ extern "C"
         memory[I] = value / 100;
         memory[I + 1] = (value / 10) % 10;
         memory[I + 2] = value % 10;
+        memoryWritten(I, 3);
         pc += 2;
         break;
       }
+      case 0x3A:
+        // Fx3A: PITCH Vx – Set the audio pattern playback rate to 4000 * 2^((Vx - 64) / 48) bits/s.
+        audioPitch = V[x];
+        pc += 2;
+        break;
       case 0x55:
       {
         // Fx55: LD [I], V0..Vx – Store registers V0 through Vx in memory starting at I.
@@ -551,6 +758,7 @@ extern "C"
         {
           memory[I + i] = V[i];
         }
+        memoryWritten(I, x + 1);
         pc += 2;
         break;
       }
@@ -596,24 +804,94 @@ extern "C"
   void run(double deltaMs)
   {
     // 1) Run CPU cycles
+#ifdef CHIP8_AOT
+    // Run ahead-of-time translated code where possible. It hands back control whenever pc
+    // reaches code that was not translated, and the interpreter executes that instruction.
+    int budget = 10;
+    while (budget > 0)
+    {
+      budget = aotExecute(budget);
+      if (budget > 0)
+      {
+        emulateCycle();
+        budget--;
+      }
+    }
+#else
     for (int i = 0; i < 10; i++)
     {
       emulateCycle();
     }
+#endif
 
     // 2) Accumulate time, decrement timers at 60 Hz
     timerAccumulator += (float)deltaMs;
     while (timerAccumulator >= TIMER_INTERVAL_MS)
     {
+      // Synthesise this timer period's audio while the sound timer still holds its value,
+      // so the tone starts and stops exactly on timer ticks.
+      if (audioSampleRate > 0 && !speculative)
+      {
+        audioSampleAccumulator += audioSampleRate / 60.0;
+        int samples = static_cast<int>(audioSampleAccumulator);
+        audioSampleAccumulator -= samples;
+        renderAudio(samples, soundTimer > 0);
+      }
       updateTimers();
       timerAccumulator -= TIMER_INTERVAL_MS;
     }
   }
 
-  // Return a pointer to the screen buffer.
+  /**
+   * Run one frame, then run ahead to cut input latency.
+   *
+   * After the real frame the state is saved, `frames` more frames are emulated with the
+   * current input, and the last of them becomes the frame returned by getScreen(). The
+   * state is then rolled back, so the speculative frames never affect the real timeline
+   * and produce no audio. With frames = 0 this is the same as run().
+   *
+   * @param deltaMs Elapsed host time for each emulated frame.
+   * @param frames  Number of frames to run ahead.
+   */
+  void runAhead(double deltaMs, int frames)
+  {
+    run(deltaMs);
+    runAheadActive = frames > 0;
+    if (!runAheadActive)
+      return;
+
+    saveState(runAheadSnapshot);
+    speculative = true;
+    for (int i = 0; i < frames; i++)
+    {
+      run(deltaMs);
+    }
+    speculative = false;
+    memcpy(aheadScreen, screen, sizeof(screen));
+    loadState(runAheadSnapshot);
+  }
+
+  /**
+   * Enable audio synthesis at the host sample rate.
+   *
+   * @param sampleRate Sample rate of the host AudioContext in Hz.
+   * @return Pointer to the AudioRing the AudioWorklet should drain.
+   */
+  AudioRing *initAudio(int sampleRate)
+  {
+    audioRing.reset();
+    audioSampleRate = sampleRate;
+    audioSampleAccumulator = 0.0;
+    audioPhase = 0.0;
+    audioPending = 0.0f;
+    audioLevel = 0.0f;
+    return &audioRing;
+  }
+
+  // Return a pointer to the screen buffer (the run-ahead frame when run-ahead is active).
   uint8_t *getScreen()
   {
-    return screen;
+    return runAheadActive ? aheadScreen : screen;
   }
 
   // Return the screen width.
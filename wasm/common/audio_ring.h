@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Capacity of the shared audio ring in samples (must be a power of two).
+const uint32_t AUDIO_RING_CAPACITY = 8192;
+
+/**
+ * Lock-free single-producer/single-consumer ring of mono float samples.
+ *
+ * The core is the only producer: it writes samples and then publishes them by
+ * advancing writeIndex. The AudioWorklet is the only consumer: it reads the
+ * samples straight out of the shared wasm heap and advances readIndex. Both
+ * indices grow monotonically and wrap at 2^32, so the fill level is always
+ * writeIndex - readIndex.
+ *
+ * The layout is read by src/utils/ring-buffer-processor.js:
+ *   +0   uint32 writeIndex
+ *   +4   uint32 readIndex
+ *   +8   uint32 capacity
+ *   +16  float  samples[capacity]
+ */
+struct AudioRing
+{
+  std::atomic<uint32_t> writeIndex;
+  std::atomic<uint32_t> readIndex;
+  uint32_t capacity;
+  uint32_t reserved;
+  float samples[AUDIO_RING_CAPACITY];
+
+  // Empty the ring. Only safe while the consumer is not running.
+  void reset()
+  {
+    writeIndex.store(0, std::memory_order_relaxed);
+    readIndex.store(0, std::memory_order_relaxed);
+    capacity = AUDIO_RING_CAPACITY;
+  }
+
+  /**
+   * Append up to count samples and return how many were written.
+   * Samples that do not fit are dropped; the producer never blocks.
+   */
+  uint32_t write(const float *src, uint32_t count)
+  {
+    uint32_t w = writeIndex.load(std::memory_order_relaxed);
+    uint32_t r = readIndex.load(std::memory_order_acquire);
+    uint32_t space = AUDIO_RING_CAPACITY - (w - r);
+    if (count > space)
+      count = space;
+    for (uint32_t i = 0; i < count; i++)
+    {
+      samples[(w + i) & (AUDIO_RING_CAPACITY - 1)] = src[i];
+    }
+    writeIndex.store(w + count, std::memory_order_release);
+    return count;
+  }
+};